@@ -0,0 +1,85 @@
+; FamiTone2 integration. The music data comes from `audio/music.txt` (see cmake/add-famitone-audio.cmake)
+; and the sound effects are written by hand below.
+;
+; AUDIO_ENABLED and AUDIO_PROFILE are passed in from CMakeLists.txt
+
+.if AUDIO_ENABLED
+
+.import famitone_update
+
+; Set by audio_init() once FamiTone2 has been initialized. NMI can fire long before that happens
+; (for instance while the first screen is being loaded) so the update has to be skipped until then.
+.segment "_pbss"
+.export audio_ready
+audio_ready: .res 1
+
+; Run the audio update at the end of NMI, after the OAM/palette/VRAM uploads have already used up vblank.
+; The music engine doesn't touch the PPU, so it's fine for it to run after rendering has started.
+.segment "_pnmi_p200"
+    lda audio_ready
+    beq @skip_audio
+.if AUDIO_PROFILE
+    ; Start marker for audio-cycles-mesen2.lua. $401C is unmapped on the NES, so this write is harmless.
+    sta $401C
+.endif
+    jsr famitone_update
+.if AUDIO_PROFILE
+    ; End marker
+    lda #0
+    sta $401C
+.endif
+@skip_audio:
+
+; FamiTone2 sound effect data.
+; Normally this would come from nsf2data, but our effects are short enough to write by hand.
+;
+; Each effect is a stream of bytes:
+;   $80+n, value - write value into slot n of the APU output buffer
+;                  0-2: pulse 1 ($4000, $4002, $4003), 3-5: pulse 2 ($4004, $4006, $4007)
+;                  6-8: triangle ($4008, $400A, $400B), 9-10: noise ($400C, $400E)
+;   $01-$7F      - keep the current registers for this many frames
+;   $00          - end of effect
+;
+; The order of the effects must match the `Sfx` enum in `audio.hpp`, and their lengths in frames are in `sfx_info`
+; in `audio.cpp`
+.segment "_prodata"
+.export famitone_sfx_data
+famitone_sfx_data:
+    .word @ntsc
+    .word @ntsc ; PAL uses the same effects, they're short enough that the speed difference doesn't matter
+@ntsc:
+    .word @sfx_shot
+    .word @sfx_hit
+    .word @sfx_pickup
+
+; Short, bright burst of high pitched noise
+@sfx_shot:
+    .byte $8a,$03, $89,$3f, $01
+    .byte $89,$3c, $01
+    .byte $8a,$05, $89,$39, $01
+    .byte $89,$36, $01
+    .byte $89,$33, $01
+    .byte $89,$30
+    .byte $00
+
+; Low rumble with a slower fade
+@sfx_hit:
+    .byte $8a,$0c, $89,$3f, $02
+    .byte $8a,$0d, $89,$3c, $02
+    .byte $8a,$0e, $89,$39, $02
+    .byte $89,$36, $02
+    .byte $89,$33, $02
+    .byte $89,$30
+    .byte $00
+
+; Rising C-E-G arpeggio on pulse 1
+@sfx_pickup:
+    .byte $80,$bc, $81,$d5, $82,$00, $03
+    .byte $81,$a9, $03
+    .byte $81,$8e, $03
+    .byte $80,$b8, $02
+    .byte $80,$b4, $02
+    .byte $80,$b0
+    .byte $00
+
+.endif
@@ -23,10 +23,10 @@ extra_nmi_code:
 .segment "_pzeropage" : zeropage
 ; Lets make an example variable in ca65 just to show how to use it in llvm-mos (see main.cpp for where we use it)
 
-; !! NOTICE !!: If you reserve ZEROPAGE variables in ca65, llvm-mos needs to be told how many bytes you reserved.
-; By default llvm-mos uses the zeropage space for holding temporary values, so if you reserve ZP variables, then you
-; need to update the CMakeLists.txt file to include the number of bytes you reserve. Look for the line `-mreserve-zp=`
-; and update that as well.
+; NOTE: If you reserve ZEROPAGE variables in ca65, llvm-mos needs to be told how many bytes you reserved.
+; By default llvm-mos uses the zeropage space for holding temporary values. The build measures the size of the
+; zeropage segments in every ca65 object and passes the total to the linker as `-mreserve-zp=` for you
+; (see `add_ca65_zp_reserve` in cmake/add-ca65-folder.cmake).
 .globalzp var_defined_in_ca65
 var_defined_in_ca65: .res 1
 
@@ -0,0 +1,154 @@
+; Hand written versions of the hottest draw routines. The C++ versions in src/metatile.cpp and src/metasprite.cpp
+; are the reference: these must produce exactly the same bytes, which the KERNEL_CHECK build checks at boot.
+; Each kernel is picked with its own option in CMakeLists.txt, and is left out of the build when it's off.
+;
+; Arguments follow the llvm-mos calling convention: 8 bit values in A, X, then __rc2, __rc3, ... and pointers in the
+; next free __rc pair. A, X, Y and __rc2 - __rc19 don't have to be saved. The return value goes in A.
+;
+; METATILE_ASM and METASPRITE_ASM are passed in from CMakeLists.txt
+
+.importzp __rc2, __rc3, __rc4, __rc5, __rc6
+
+; See NT_UPD_VERT and NT_UPD_EOF in nesdoug.h
+NT_UPD_VERT = $80
+NT_UPD_EOF  = $ff
+
+.if METATILE_ASM
+
+.import VRAM_BUF
+.importzp VRAM_INDEX
+
+; Shared start of both metatile kernels. Queues the headers of the two vertical columns for the metatile at
+; nametable A, column X, row __rc2, with `length` tiles each. Leaves VRAM_INDEX in X and the tile pointer in __rc4/5.
+;
+; PPU address of the left column: $2000 | nmt << 8 | y << 5 | x, split up into bytes without any 16 bit math.
+;   high = $20 | nmt | y >> 3
+;   low  = (y & 7) << 5 | x
+; x is at most 30 so the right column never carries into the high byte.
+.macro metatile_headers length
+    sta __rc3                   ; nmt
+    stx __rc6                   ; x
+    lda __rc2
+    asl
+    asl
+    asl
+    asl
+    asl
+    ora __rc6
+    sta __rc6                   ; low byte
+    lda __rc2
+    lsr
+    lsr
+    lsr
+    ora __rc3
+    ora #($20 | NT_UPD_VERT)
+    ldx VRAM_INDEX
+    sta VRAM_BUF+0,x
+    sta VRAM_BUF+length+3,x
+    lda __rc6
+    sta VRAM_BUF+1,x
+    clc
+    adc #1
+    sta VRAM_BUF+length+4,x
+    lda #length
+    sta VRAM_BUF+2,x
+    sta VRAM_BUF+length+5,x
+.endmacro
+
+; Write tile row `row` of the metatile: the high nibble goes in the left column, the low nibble in the right one.
+.macro metatile_row length, row
+    ldy #row
+    lda (__rc4),y
+    tay
+    and #$0f
+    sta VRAM_BUF+length+6+row,x
+    tya
+    lsr
+    lsr
+    lsr
+    lsr
+    sta VRAM_BUF+3+row,x
+.endmacro
+
+.macro metatile_end length
+    lda #NT_UPD_EOF
+    sta VRAM_BUF+2*length+6,x
+    txa
+    clc
+    adc #(2*length+6)
+    sta VRAM_INDEX
+.endmacro
+
+.segment "_ptext"
+
+; extern "C" void draw_metatile_2_2(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_2* tile)
+.export draw_metatile_2_2
+draw_metatile_2_2:
+    metatile_headers 2
+    metatile_row 2, 0
+    metatile_row 2, 1
+    metatile_end 2
+    rts
+
+; extern "C" void draw_metatile_2_3(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_3* tile)
+.export draw_metatile_2_3
+draw_metatile_2_3:
+    metatile_headers 3
+    metatile_row 3, 0
+    metatile_row 3, 1
+    metatile_row 3, 2
+    metatile_end 3
+    rts
+
+.endif
+
+.if METASPRITE_ASM
+
+; neslib's shadow OAM, DMA'd to the PPU every NMI
+OAM_BUF = $0200
+
+; Metasprite end marker, see metasprites.h
+METASPRITE_END = $80
+
+.segment "_ptext"
+
+; extern "C" uint8_t draw_metasprite(uint8_t x, uint8_t y, const int8_t* data, uint8_t oam_offset)
+;
+; A = x, X = y, __rc2/3 = data, __rc4 = oam_offset. Returns the new oam_offset.
+; The OAM offset stays in X the whole time and the data is walked with Y, so a sprite is ~50 cycles.
+.export draw_metasprite
+draw_metasprite:
+    sta __rc5                   ; x
+    stx __rc6                   ; y
+    ldx __rc4
+    ldy #0
+@next_sprite:
+    lda (__rc2),y               ; x offset
+    cmp #METASPRITE_END
+    beq @done
+    clc
+    adc __rc5
+    sta OAM_BUF+3,x
+    iny
+    lda (__rc2),y               ; y offset
+    clc
+    adc __rc6
+    sta OAM_BUF+0,x
+    iny
+    lda (__rc2),y               ; tile
+    sta OAM_BUF+1,x
+    iny
+    lda (__rc2),y               ; attributes
+    sta OAM_BUF+2,x
+    iny
+    inx
+    inx
+    inx
+    inx
+    ; Metasprites are at most 63 sprites long, so Y can't wrap. OAM can, the same as in neslib.
+    jmp @next_sprite
+@done:
+    txa
+    rts
+
+.endif
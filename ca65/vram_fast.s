@@ -0,0 +1,146 @@
+; Unrolled NMI upload path for the VRAM updates the game makes the most: 2x2 and 2x3 metatiles.
+; See src/vram_fast.hpp for the C++ side and the cycle comparison with nesdoug's VRAM_BUF.
+;
+; The stock VRAM_BUF parser handles any run length in either direction, so every packet pays for figuring out its
+; type, setting the increment mode, and a counted copy loop. Here the packet shapes are fixed, so each one gets a
+; straight line handler and the increment mode is set once for the whole buffer.
+;
+; Buffer format, one opcode byte followed by the PPU address (high byte first) and the tiles:
+;   VRAM_FAST_METATILE_2_2 hi lo  tl bl tr br           - 2 columns of 2 tiles
+;   VRAM_FAST_METATILE_2_3 hi lo  tl ml bl tr mr br     - 2 columns of 3 tiles
+;   VRAM_FAST_EOF
+; Metatiles never cross a nametable row, so the right column is always at lo + 1 with the same hi.
+;
+; VRAM_FAST and VRAM_FAST_PROFILE are passed in from CMakeLists.txt
+
+.if VRAM_FAST
+
+; The opcodes are picked so the dispatch is a couple of flag tests instead of a compare chain.
+; Must match the `Vram_Fast_Ops` enum in src/vram_fast.hpp
+VRAM_FAST_EOF          = $00
+VRAM_FAST_METATILE_2_2 = $01
+VRAM_FAST_METATILE_2_3 = $80
+
+; Must match VRAM_FAST_BUF_SIZE in src/vram_fast.hpp
+VRAM_FAST_BUF_SIZE = 96
+
+PPU_CTRL = $2000
+PPU_ADDR = $2006
+PPU_DATA = $2007
+
+.importzp PPU_CTRL_VAR, PPU_MASK_VAR
+
+.segment "_pbss"
+.export VRAM_FAST_BUF, VRAM_FAST_INDEX, VRAM_FAST_LOCK
+VRAM_FAST_BUF: .res VRAM_FAST_BUF_SIZE
+; Offset of the EOF at the end of the buffer, where the next packet goes.
+VRAM_FAST_INDEX: .res 1
+; Set while the game is writing a packet. NMI leaves the buffer alone until the next frame if it's set.
+VRAM_FAST_LOCK: .res 1
+
+; Runs before neslib's own VRAM_BUF update, which sets the scroll when it's done and so has to come after any
+; PPU_ADDR writes. Check the order in the .map file if the number here (or in the SDK) ever changes.
+.segment "_pnmi_p050"
+    ; Same as neslib, don't touch VRAM when rendering is off. The game may be in the middle of using it.
+    lda PPU_MASK_VAR
+    and #%00011000
+    beq @skip_fast_upload
+    lda VRAM_FAST_LOCK
+    bne @skip_fast_upload
+    jsr vram_fast_flush
+@skip_fast_upload:
+
+.segment "_ptext"
+
+; Upload everything in the buffer and empty it.
+; NMI calls this every frame, the game can also call it directly while rendering is off.
+; Cycle counts for each instruction are in the comments, the totals are in src/vram_fast.hpp.
+.export vram_fast_flush
+vram_fast_flush:
+    ldx #0                      ; 2
+    lda VRAM_FAST_BUF           ; 4
+    beq @empty                  ; 2
+.if VRAM_FAST_PROFILE
+    ; Start marker for vram-upload-mesen2.lua. $401F is unmapped on the NES, so this write is harmless.
+    sta $401F
+.endif
+    ; Every column is vertical, so +32 mode for the whole buffer.
+    lda PPU_CTRL_VAR            ; 3
+    ora #%00000100              ; 2
+    sta PPU_CTRL                ; 4
+    clc                         ; 2
+
+    ; The handlers add the packet size to X with an adc that never carries out, so the carry is clear at the top
+    ; of every packet. The lsr below sets it again for the 2x2 metatiles only.
+@next_packet:
+    lda VRAM_FAST_BUF,x         ; 4
+    bmi @metatile_2_3           ; 2/3
+    lsr                         ; 2
+    bcs @metatile_2_2           ; 2/3
+    ; Only VRAM_FAST_EOF is left
+    jmp @done                   ; 3
+
+@metatile_2_2:
+    lda VRAM_FAST_BUF+1,x       ; 4
+    sta PPU_ADDR                ; 4
+    ldy VRAM_FAST_BUF+2,x       ; 4
+    sty PPU_ADDR                ; 4
+    lda VRAM_FAST_BUF+3,x       ; 4
+    sta PPU_DATA                ; 4
+    lda VRAM_FAST_BUF+4,x       ; 4
+    sta PPU_DATA                ; 4
+    lda VRAM_FAST_BUF+1,x       ; 4
+    sta PPU_ADDR                ; 4
+    iny                         ; 2
+    sty PPU_ADDR                ; 4
+    lda VRAM_FAST_BUF+5,x       ; 4
+    sta PPU_DATA                ; 4
+    lda VRAM_FAST_BUF+6,x       ; 4
+    sta PPU_DATA                ; 4
+    txa                         ; 2
+    ; The carry is set from the dispatch, so this adds 7.
+    adc #6                      ; 2
+    tax                         ; 2
+    jmp @next_packet            ; 3
+
+@metatile_2_3:
+    lda VRAM_FAST_BUF+1,x       ; 4
+    sta PPU_ADDR                ; 4
+    ldy VRAM_FAST_BUF+2,x       ; 4
+    sty PPU_ADDR                ; 4
+    lda VRAM_FAST_BUF+3,x       ; 4
+    sta PPU_DATA                ; 4
+    lda VRAM_FAST_BUF+4,x       ; 4
+    sta PPU_DATA                ; 4
+    lda VRAM_FAST_BUF+5,x       ; 4
+    sta PPU_DATA                ; 4
+    lda VRAM_FAST_BUF+1,x       ; 4
+    sta PPU_ADDR                ; 4
+    iny                         ; 2
+    sty PPU_ADDR                ; 4
+    lda VRAM_FAST_BUF+6,x       ; 4
+    sta PPU_DATA                ; 4
+    lda VRAM_FAST_BUF+7,x       ; 4
+    sta PPU_DATA                ; 4
+    lda VRAM_FAST_BUF+8,x       ; 4
+    sta PPU_DATA                ; 4
+    txa                         ; 2
+    adc #9                      ; 2
+    tax                         ; 2
+    jmp @next_packet            ; 3
+
+@done:
+    ; Put the increment mode back for neslib and the game.
+    lda PPU_CTRL_VAR
+    sta PPU_CTRL
+    lda #VRAM_FAST_EOF
+    sta VRAM_FAST_BUF
+    sta VRAM_FAST_INDEX
+.if VRAM_FAST_PROFILE
+    ; End marker
+    sta $401F
+.endif
+@empty:
+    rts
+
+.endif
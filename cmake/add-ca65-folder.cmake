@@ -2,7 +2,7 @@
 function(add_ca65_source)
   set(options)
   set(oneValueArgs TARGET SRC)
-  set(multiValueArgs)
+  set(multiValueArgs DEFINES)
   cmake_parse_arguments(CA65 "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
 
   if (NOT CA65_TARGET)
@@ -27,16 +27,58 @@ function(add_ca65_source)
       CONFIGURE_DEPENDS
       "${CA65_SRC}/*.[s|S|inc|asm|ASM]"
   )
+  # Pass any DEFINES along to ca65 as `-D NAME=VALUE` so the asm can use `.if NAME`
+  set(CA65_DEFINE_ARGS)
+  foreach(DEF ${CA65_DEFINES})
+    list(APPEND CA65_DEFINE_ARGS -D ${DEF})
+  endforeach()
+
   foreach(SRC ${CA65_SRCS})
     cmake_path(GET SRC STEM filestem)
     cmake_path(GET SRC PARENT_PATH filepath)
     add_custom_command(
       OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/gen/obj/${filestem}.o
-      COMMAND ${CA65_BIN} --bin-include-dir ${filepath} --include-dir ${filepath} -o ${CMAKE_CURRENT_BINARY_DIR}/gen/obj/${filestem}.o ${SRC}
+      COMMAND ${CA65_BIN} ${CA65_DEFINE_ARGS} --bin-include-dir ${filepath} --include-dir ${filepath} -o ${CMAKE_CURRENT_BINARY_DIR}/gen/obj/${filestem}.o ${SRC}
       DEPENDS ${SRC}
       VERBATIM
     )
     target_sources(${CA65_TARGET} PRIVATE ${CMAKE_CURRENT_BINARY_DIR}/gen/obj/${filestem}.o)
+    # Keep track of the objects so other steps (like add_ca65_zp_reserve) can inspect them
+    set_property(TARGET ${CA65_TARGET} APPEND PROPERTY CA65_OBJECTS ${CMAKE_CURRENT_BINARY_DIR}/gen/obj/${filestem}.o)
   endforeach()
   target_include_directories(${CA65_TARGET} PRIVATE gen)
 endfunction()
+
+# Measures how much zeropage the ca65 objects of TARGET reserve and passes the total to the linker
+# as `-mreserve-zp=N`, so it never has to be counted and updated by hand.
+# Must be called after add_ca65_source.
+function(add_ca65_zp_reserve)
+  set(options)
+  set(oneValueArgs TARGET)
+  set(multiValueArgs)
+  cmake_parse_arguments(ZP "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+  if (NOT ZP_TARGET)
+    message(FATAL_ERROR "ZP reserve TARGET is required!")
+  endif()
+
+  get_property(ca65_objects TARGET ${ZP_TARGET} PROPERTY CA65_OBJECTS)
+  set(rsp ${CMAKE_CURRENT_BINARY_DIR}/gen/zp-reserve.rsp)
+
+  add_custom_command(
+    OUTPUT ${rsp}
+    COMMAND ${CMAKE_COMMAND}
+      -DOD65_BIN=${OD65_BIN}
+      "-DOBJECTS=${ca65_objects}"
+      -DOUTPUT=${rsp}
+      -P ${CMAKE_SOURCE_DIR}/cmake/ca65-zp-usage.cmake
+    DEPENDS ${ca65_objects} ${CMAKE_SOURCE_DIR}/cmake/ca65-zp-usage.cmake
+    COMMENT "Measuring ca65 zeropage usage"
+    VERBATIM
+  )
+  # Listing the response file as a source makes sure it's generated before linking,
+  # and LINK_DEPENDS relinks whenever the amount of reserved zeropage changes.
+  target_sources(${ZP_TARGET} PRIVATE ${rsp})
+  set_property(TARGET ${ZP_TARGET} APPEND PROPERTY LINK_DEPENDS ${rsp})
+  target_link_options(${ZP_TARGET} PRIVATE "@${rsp}")
+endfunction()
@@ -0,0 +1,66 @@
+
+# Converts a FamiTracker text export (File -> Export text in FamiTracker) into FamiTone2 music data
+# using the `text2data` tool that ships with FamiTone2, then assembles it with ca65 and links it into TARGET.
+#
+# The converted data is exported to C/C++ as `famitone_music_data`.
+#
+# If text2data can't be found, AUDIO_FOUND is set to Off in the parent scope so the caller can
+# build without music instead of failing the whole build.
+function(add_famitone_music)
+  set(options)
+  set(oneValueArgs TARGET SRC)
+  set(multiValueArgs)
+  cmake_parse_arguments(FT "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+  if (NOT FT_TARGET)
+    message(FATAL_ERROR "FamiTone2 music TARGET is required!")
+  endif()
+  if (NOT FT_SRC)
+    message(FATAL_ERROR "FamiTone2 music SRC file is required!")
+  endif()
+  if (NOT CA65_BIN)
+    find_program(CA65_BIN ca65 REQUIRED HINTS ${CMAKE_SOURCE_DIR}/tools/${CMAKE_HOST_SYSTEM_NAME}/cc65)
+  endif()
+
+  find_program(TEXT2DATA_BIN text2data HINTS ${CMAKE_SOURCE_DIR}/tools/${CMAKE_HOST_SYSTEM_NAME}/famitone2)
+  if (NOT TEXT2DATA_BIN)
+    message(WARNING "FamiTone2's text2data was not found, building without audio. "
+                    "Put it on your PATH or in tools/${CMAKE_HOST_SYSTEM_NAME}/famitone2 to enable music.")
+    set(AUDIO_FOUND Off PARENT_SCOPE)
+    return()
+  endif()
+
+  cmake_path(GET FT_SRC STEM filestem)
+  set(outdir ${CMAKE_CURRENT_BINARY_DIR}/gen/audio)
+
+  # text2data writes its output next to the input file, so work on a copy in the build folder
+  # to keep the source tree clean.
+  add_custom_command(
+    OUTPUT ${outdir}/${filestem}.s
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${outdir}
+    COMMAND ${CMAKE_COMMAND} -E copy ${FT_SRC} ${outdir}/${filestem}.txt
+    COMMAND ${TEXT2DATA_BIN} ${filestem}.txt -ca65
+    WORKING_DIRECTORY ${outdir}
+    DEPENDS ${FT_SRC}
+    COMMENT "Converting ${filestem}.txt to FamiTone2 music data"
+    VERBATIM
+  )
+
+  # text2data only emits the data itself, so wrap it with the segment and export llvm-mos needs.
+  file(WRITE ${outdir}/${filestem}_wrapper.s
+    "; Generated by add-famitone-audio.cmake, do not edit.\n"
+    ".segment \"_prodata\"\n"
+    ".export famitone_music_data\n"
+    "famitone_music_data:\n"
+    ".include \"${filestem}.s\"\n"
+  )
+
+  add_custom_command(
+    OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/gen/obj/${filestem}_music.o
+    COMMAND ${CA65_BIN} --include-dir ${outdir} -o ${CMAKE_CURRENT_BINARY_DIR}/gen/obj/${filestem}_music.o ${outdir}/${filestem}_wrapper.s
+    DEPENDS ${outdir}/${filestem}.s ${outdir}/${filestem}_wrapper.s
+    VERBATIM
+  )
+  target_sources(${FT_TARGET} PRIVATE ${CMAKE_CURRENT_BINARY_DIR}/gen/obj/${filestem}_music.o)
+  set(AUDIO_FOUND On PARENT_SCOPE)
+endfunction()
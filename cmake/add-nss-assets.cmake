@@ -0,0 +1,84 @@
+# Converts NEXXT session files (.nss) into generated sources for TARGET as part of the build, so the data in the
+# ROM always matches the session file. Each asset only gets converted again when its .nss (or the converter)
+# changes. The generated files go in gen/assets, which is added to TARGET's include path.
+#
+# Every conversion also records the asset's size, see add_asset_size_report.
+
+# Nametable + attributes of the session as NESLIB RLE data, in gen/assets/<name>.nrle.inc.
+# Use it like `const unsigned char screen[] = { #include "<name>.nrle.inc" };`
+function(add_nss_nametable)
+  set(options)
+  set(oneValueArgs TARGET SRC)
+  set(multiValueArgs)
+  cmake_parse_arguments(NSS "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+  if (NOT NSS_TARGET OR NOT NSS_SRC)
+    message(FATAL_ERROR "NSS nametable TARGET and SRC are required!")
+  endif()
+
+  cmake_path(GET NSS_SRC STEM filestem)
+  _add_nss_conversion(${NSS_TARGET} ${NSS_SRC} nametable ${filestem}.nrle.inc)
+endfunction()
+
+# All named metasprites of the session as a header, in gen/assets/<HEADER>.
+function(add_nss_metasprites)
+  set(options)
+  set(oneValueArgs TARGET SRC HEADER)
+  set(multiValueArgs)
+  cmake_parse_arguments(NSS "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+  if (NOT NSS_TARGET OR NOT NSS_SRC OR NOT NSS_HEADER)
+    message(FATAL_ERROR "NSS metasprites TARGET, SRC and HEADER are required!")
+  endif()
+
+  _add_nss_conversion(${NSS_TARGET} ${NSS_SRC} metasprites ${NSS_HEADER})
+endfunction()
+
+function(_add_nss_conversion target src mode output_name)
+  set(outdir ${CMAKE_CURRENT_BINARY_DIR}/gen/assets)
+  set(output ${outdir}/${output_name})
+  set(size_file ${outdir}/${output_name}.size)
+
+  add_custom_command(
+    OUTPUT ${output} ${size_file}
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${outdir}
+    COMMAND ${CMAKE_COMMAND}
+      -DMODE=${mode}
+      -DINPUT=${src}
+      -DOUTPUT=${output}
+      -DSIZE_FILE=${size_file}
+      -P ${CMAKE_SOURCE_DIR}/cmake/nss-convert.cmake
+    DEPENDS ${src} ${CMAKE_SOURCE_DIR}/cmake/nss-convert.cmake
+    COMMENT "Converting ${output_name} from ${src}"
+    VERBATIM
+  )
+  # Listing the output as a source makes sure it's generated before anything that includes it is compiled.
+  target_sources(${target} PRIVATE ${output})
+  target_include_directories(${target} PRIVATE ${outdir})
+  set_property(TARGET ${target} APPEND PROPERTY ASSET_SIZE_FILES ${size_file})
+endfunction()
+
+# Prints the raw and ROM size of every converted asset after each build, and saves it to asset-report.txt.
+# Must be called after all of the add_nss_* calls.
+function(add_asset_size_report)
+  set(options)
+  set(oneValueArgs TARGET)
+  set(multiValueArgs)
+  cmake_parse_arguments(ASSET "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+  if (NOT ASSET_TARGET)
+    message(FATAL_ERROR "Asset size report TARGET is required!")
+  endif()
+
+  get_property(size_files TARGET ${ASSET_TARGET} PROPERTY ASSET_SIZE_FILES)
+  add_custom_command(
+    TARGET ${ASSET_TARGET}
+    POST_BUILD
+    COMMAND ${CMAKE_COMMAND}
+      "-DSIZE_FILES=${size_files}"
+      -DOUTPUT=${CMAKE_BINARY_DIR}/asset-report.txt
+      -P ${CMAKE_SOURCE_DIR}/cmake/asset-report.cmake
+    COMMENT "Generating asset size report"
+    VERBATIM
+  )
+endfunction()
@@ -0,0 +1,58 @@
+# Script mode helper that sums up the size files written by nss-convert.cmake into a report.
+#
+# Usage: cmake "-DSIZE_FILES=<a.size;b.size;...>" -DOUTPUT=<report.txt> -P asset-report.cmake
+#
+# "raw" is the size of the data before compression, "rom" is what the asset actually costs in PRG ROM.
+
+if (NOT SIZE_FILES OR NOT OUTPUT)
+  message(FATAL_ERROR "SIZE_FILES and OUTPUT are required")
+endif()
+
+# Left align `text` in a column of `width` characters
+function(pad_right text width out)
+  string(LENGTH "${text}" len)
+  set(padding "")
+  if (len LESS width)
+    math(EXPR pad "${width} - ${len}")
+    string(REPEAT " " ${pad} padding)
+  endif()
+  set(${out} "${text}${padding}" PARENT_SCOPE)
+endfunction()
+
+# Right align `text` in a column of `width` characters
+function(pad_left text width out)
+  string(LENGTH "${text}" len)
+  set(padding "")
+  if (len LESS width)
+    math(EXPR pad "${width} - ${len}")
+    string(REPEAT " " ${pad} padding)
+  endif()
+  set(${out} "${padding}${text}" PARENT_SCOPE)
+endfunction()
+
+set(report "Asset report\n\n")
+pad_right("asset" 28 header)
+string(APPEND report "${header}   raw    rom\n")
+set(total_raw 0)
+set(total_rom 0)
+foreach(size_file IN LISTS SIZE_FILES)
+  file(READ ${size_file} line)
+  string(STRIP "${line}" line)
+  list(GET line 0 name)
+  list(GET line 1 raw)
+  list(GET line 2 rom)
+  math(EXPR total_raw "${total_raw} + ${raw}")
+  math(EXPR total_rom "${total_rom} + ${rom}")
+
+  pad_right("${name}" 28 name)
+  pad_left("${raw}" 6 raw)
+  pad_left("${rom}" 7 rom)
+  string(APPEND report "${name}${raw}${rom}\n")
+endforeach()
+pad_right("total" 28 name)
+pad_left("${total_raw}" 6 raw)
+pad_left("${total_rom}" 7 rom)
+string(APPEND report "${name}${raw}${rom}\n")
+
+message("${report}")
+file(WRITE ${OUTPUT} "${report}")
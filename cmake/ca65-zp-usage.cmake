@@ -0,0 +1,45 @@
+# Script mode helper for add_ca65_zp_reserve (see add-ca65-folder.cmake)
+#
+# Usage: cmake -DOD65_BIN=<od65> -DOBJECTS=<obj;obj;...> -DOUTPUT=<file.rsp> -P ca65-zp-usage.cmake
+#
+# Runs `od65 --dump-segsize` on every ca65 object and adds up the size of every zeropage segment.
+# The total is written to OUTPUT as `-mreserve-zp=N`, which is passed to the linker as a response file.
+
+if (NOT OD65_BIN OR NOT OUTPUT)
+  message(FATAL_ERROR "OD65_BIN and OUTPUT are required")
+endif()
+
+set(total 0)
+foreach(obj ${OBJECTS})
+  execute_process(
+    COMMAND ${OD65_BIN} --dump-segsize ${obj}
+    OUTPUT_VARIABLE dump
+    RESULT_VARIABLE result
+  )
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "od65 failed on ${obj}")
+  endif()
+
+  # Each segment is listed as `    name:    size`. llvm-mos zeropage sections (.zp, .zp.*, .zeropage)
+  # show up in ca65 as _pzp... and _pzeropage
+  string(REGEX MATCHALL "[ \t]_pz[A-Za-z0-9_]*:[ \t]+[0-9]+" segments "${dump}")
+  foreach(segment ${segments})
+    string(REGEX REPLACE ".*:[ \t]+([0-9]+)" "\\1" size "${segment}")
+    string(STRIP "${segment}" name)
+    string(REGEX REPLACE ":.*" "" name "${name}")
+    cmake_path(GET obj FILENAME objname)
+    message(STATUS "  ${objname}: ${name} uses ${size} bytes of zeropage")
+    math(EXPR total "${total} + ${size}")
+  endforeach()
+endforeach()
+
+message(STATUS "ca65 zeropage usage: ${total} bytes")
+
+# Only touch the file when the value changes so the link isn't redone for nothing.
+set(content "-mreserve-zp=${total}\n")
+if (EXISTS ${OUTPUT})
+  file(READ ${OUTPUT} old_content)
+endif()
+if (NOT "${old_content}" STREQUAL "${content}")
+  file(WRITE ${OUTPUT} "${content}")
+endif()
@@ -0,0 +1,66 @@
+# Script mode helper that generates the Mesen 2 script for the binary event log from the list of events,
+# so the ids and formats in the script always match the ROM.
+#
+# Usage: cmake -DINPUT=<events.inc> -DOUTPUT=<event-log-mesen2.lua> -P event-log-lua.cmake
+
+if (NOT INPUT OR NOT OUTPUT)
+  message(FATAL_ERROR "INPUT and OUTPUT are required")
+endif()
+
+file(STRINGS ${INPUT} lines REGEX "^EVENT\\(")
+
+set(table "")
+set(id 0)
+foreach(line IN LISTS lines)
+  if (NOT line MATCHES "^EVENT\\(([A-Za-z0-9_]+), *\"(.*)\"\\)$")
+    message(FATAL_ERROR "Can't read `${line}` in ${INPUT}")
+  endif()
+  set(name "${CMAKE_MATCH_1}")
+  set(format "${CMAKE_MATCH_2}")
+  string(APPEND table "  [${id}] = { name = \"${name}\", format = \"${format}\" },\n")
+  math(EXPR id "${id} + 1")
+endforeach()
+if (id EQUAL 0)
+  message(FATAL_ERROR "${INPUT} has no events")
+endif()
+
+cmake_path(GET INPUT FILENAME input_name)
+file(WRITE ${OUTPUT} "-- Generated from ${input_name} by event-log-lua.cmake, do not edit.
+-- Use this script with Mesen 2 on a build configured with -DEVENT_LOG=On to print the game's event log.
+-- event_log_flush() in src/event_log.cpp writes the events of each frame to $401A: how many there are, then
+-- 4 bytes for each one, its id in src/events.inc and 3 arguments.
+-- For example:
+--   $ mesen gg-llvm-mos-sample.nes build/event-log-mesen2.lua
+
+events = {
+${table}}
+
+-- Events still to come in this frame's batch, and the bytes of the one being read
+left = 0
+record = {}
+
+function print_event(id, args)
+  event = events[id]
+  if (event == nil) then
+    emu.log(\"unknown event \" .. id .. \" (\" .. args[1] .. \", \" .. args[2] .. \", \" .. args[3] .. \")\")
+    return
+  end
+  text = string.gsub(event.format, \"{(%d)}\", function(i) return tostring(args[tonumber(i) + 1]) end)
+  emu.log(\"frame \" .. emu.getState()[\"ppu.frameCount\"] .. \": \" .. text)
+end
+
+function cb(address, value)
+  if (left == 0) then
+    left = value
+    return
+  end
+  table.insert(record, value)
+  if (#record == 4) then
+    print_event(record[1], { record[2], record[3], record[4] })
+    record = {}
+    left = left - 1
+  end
+end
+
+emu.addMemoryCallback(cb, emu.callbackType.write, 0x401A)
+")
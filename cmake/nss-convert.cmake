@@ -0,0 +1,252 @@
+# Script mode helper that converts a NEXXT session file (.nss) into data the game can include.
+#
+# Usage: cmake -DMODE=<nametable|metasprites> -DINPUT=<file.nss> -DOUTPUT=<file> -DSIZE_FILE=<file.size>
+#              -P nss-convert.cmake
+#
+# MODE nametable   - the nametable and attributes, NESLIB RLE compressed (same as NEXXT's "Save RLE"),
+#                    written as a comma separated list of bytes to `#include` in an array
+# MODE metasprites - every named metasprite, written as a header in the same format NEXXT exports
+#                    (`<bank>_<name>_data` arrays and a `<bank>_list` of them)
+#
+# SIZE_FILE gets a single `name;raw bytes;rom bytes` line for the asset size report.
+
+if (NOT MODE OR NOT INPUT OR NOT OUTPUT OR NOT SIZE_FILE)
+  message(FATAL_ERROR "MODE, INPUT, OUTPUT and SIZE_FILE are required")
+endif()
+
+file(STRINGS ${INPUT} session)
+cmake_path(GET INPUT FILENAME asset_name)
+
+# Value of a `Key=value` line in the session
+function(nss_field key out)
+  foreach(line IN LISTS session)
+    if (line MATCHES "^${key}=(.*)$")
+      set(${out} "${CMAKE_MATCH_1}" PARENT_SCOPE)
+      return()
+    endif()
+  endforeach()
+  message(FATAL_ERROR "${INPUT} has no ${key}")
+endfunction()
+
+# NEXXT stores binary data as hex bytes, where `XX[n]` means the byte XX n times (n is hex too).
+# Decodes into a list of decimal bytes, stopping after `limit` bytes if it's not 0.
+function(nss_decode data limit out)
+  string(REGEX MATCHALL "[0-9a-fA-F][0-9a-fA-F](\\[[0-9a-fA-F]+\\])?" tokens "${data}")
+  set(bytes "")
+  set(count 0)
+  foreach(token IN LISTS tokens)
+    string(SUBSTRING "${token}" 0 2 byte_hex)
+    math(EXPR byte "0x${byte_hex}")
+    set(repeat 1)
+    if (token MATCHES "\\[([0-9a-fA-F]+)\\]")
+      math(EXPR repeat "0x${CMAKE_MATCH_1}")
+    endif()
+    if (limit GREATER 0 AND count GREATER_EQUAL limit)
+      break()
+    endif()
+    if (limit GREATER 0)
+      math(EXPR left "${limit} - ${count}")
+      if (repeat GREATER left)
+        set(repeat ${left})
+      endif()
+    endif()
+    string(REPEAT "${byte};" ${repeat} run)
+    string(APPEND bytes "${run}")
+    math(EXPR count "${count} + ${repeat}")
+  endforeach()
+  string(REGEX REPLACE ";$" "" bytes "${bytes}")
+  set(${out} "${bytes}" PARENT_SCOPE)
+endfunction()
+
+function(to_hex value out)
+  math(EXPR hex "${value}" OUTPUT_FORMAT HEXADECIMAL)
+  string(SUBSTRING "${hex}" 2 -1 digits)
+  string(LENGTH "${digits}" len)
+  if (len LESS 2)
+    set(digits "0${digits}")
+  endif()
+  set(${out} "0x${digits}" PARENT_SCOPE)
+endfunction()
+
+if (MODE STREQUAL "nametable")
+  nss_field(NameTable name_data)
+  nss_field(AttrTable attr_data)
+  nss_decode("${name_data}" 960 names)
+  nss_decode("${attr_data}" 64 attrs)
+  set(bytes ${names} ${attrs})
+  list(LENGTH bytes raw_size)
+
+  # The tag is the least used byte value (the lowest one on a tie), so it's never confused with the data.
+  foreach(byte IN LISTS bytes)
+    if (DEFINED used_${byte})
+      math(EXPR used_${byte} "${used_${byte}} + 1")
+    else()
+      set(used_${byte} 1)
+    endif()
+  endforeach()
+  set(tag 0)
+  set(tag_uses ${raw_size})
+  foreach(byte RANGE 255)
+    if (NOT DEFINED used_${byte})
+      set(tag ${byte})
+      break()
+    endif()
+    if (used_${byte} LESS tag_uses)
+      set(tag ${byte})
+      set(tag_uses ${used_${byte}})
+    endif()
+  endforeach()
+
+  # Each run of up to 255 equal bytes is written as the byte, then `tag, n` for n more of it.
+  # A run of 2 just writes the byte twice, it's the same size. `tag, 0` ends the data.
+  set(rle ${tag})
+  set(run_byte -1)
+  set(run_length 0)
+  macro(flush_run)
+    if (run_length GREATER 0)
+      list(APPEND rle ${run_byte})
+      if (run_length EQUAL 2)
+        list(APPEND rle ${run_byte})
+      elseif (run_length GREATER 2)
+        math(EXPR more "${run_length} - 1")
+        list(APPEND rle ${tag} ${more})
+      endif()
+    endif()
+  endmacro()
+  foreach(byte IN LISTS bytes)
+    if (byte EQUAL run_byte AND run_length LESS 255)
+      math(EXPR run_length "${run_length} + 1")
+    else()
+      flush_run()
+      set(run_byte ${byte})
+      set(run_length 1)
+    endif()
+  endforeach()
+  flush_run()
+  list(APPEND rle ${tag} 0)
+
+  set(text "// Generated from ${asset_name} by nss-convert.cmake, do not edit.\n")
+  set(column 0)
+  foreach(byte IN LISTS rle)
+    to_hex(${byte} hex)
+    string(APPEND text "${hex},")
+    math(EXPR column "${column} + 1")
+    if (column EQUAL 16)
+      string(APPEND text "\n")
+      set(column 0)
+    endif()
+  endforeach()
+  string(APPEND text "\n")
+  list(LENGTH rle rom_size)
+
+elseif (MODE STREQUAL "metasprites")
+  nss_field(MetaSpriteBankName bank)
+  nss_field(VarSpriteGridX origin_x)
+  nss_field(VarSpriteGridY origin_y)
+
+  # Names are stored as MetaSprite0=..., MetaSprite1=..., in order and without gaps.
+  set(names "")
+  foreach(line IN LISTS session)
+    if (line MATCHES "^MetaSprite([0-9]+)=(.+)$")
+      list(APPEND names "${CMAKE_MATCH_2}")
+    endif()
+  endforeach()
+  list(LENGTH names count)
+  if (count EQUAL 0)
+    message(FATAL_ERROR "${INPUT} has no named metasprites")
+  endif()
+
+  # Every metasprite has room for 64 sprites of y, tile, attributes, x (relative to the sprite grid origin).
+  # A y of 0xff marks the end.
+  nss_field(MetaSprites sprite_data)
+  math(EXPR limit "${count} * 256")
+  nss_decode("${sprite_data}" ${limit} bytes)
+
+  set(text "")
+  set(list_text "const int8_t* const ${bank}_list[]={\n\n")
+  set(raw_size 0)
+  set(rom_size 0)
+  math(EXPR last "${count} - 1")
+  foreach(index RANGE ${last})
+    list(GET names ${index} name)
+    string(APPEND text "const int8_t ${bank}_${name}_data[]={\n\n")
+    math(EXPR first_byte "${index} * 256")
+    list(SUBLIST bytes ${first_byte} 256 sprite_bytes)
+    foreach(sprite RANGE 63)
+      math(EXPR offset "${sprite} * 4")
+      list(GET sprite_bytes ${offset} y)
+      if (y EQUAL 255)
+        break()
+      endif()
+      math(EXPR offset_tile "${offset} + 1")
+      math(EXPR offset_attr "${offset} + 2")
+      math(EXPR offset_x "${offset} + 3")
+      list(GET sprite_bytes ${offset_tile} tile)
+      list(GET sprite_bytes ${offset_attr} attr)
+      list(GET sprite_bytes ${offset_x} x)
+
+      # Same layout as NEXXT's export: right aligned offsets, with the sign in front of the padding.
+      set(fields "")
+      foreach(value_origin "${x};${origin_x}" "${y};${origin_y}")
+        list(GET value_origin 0 value)
+        list(GET value_origin 1 origin)
+        math(EXPR value "${value} - ${origin}")
+        if (value LESS 0)
+          math(EXPR value "-${value}")
+          string(LENGTH "${value}" len)
+          set(padding "")
+          if (len LESS 2)
+            set(padding " ")
+          endif()
+          string(APPEND fields "-${padding}${value},")
+        else()
+          string(LENGTH "${value}" len)
+          math(EXPR pad "3 - ${len}")
+          string(REPEAT " " ${pad} padding)
+          string(APPEND fields "${padding}${value},")
+        endif()
+      endforeach()
+      to_hex(${tile} tile_hex)
+      math(EXPR palette "${attr} & 0x3f")
+      set(attr_text "${palette}")
+      math(EXPR flip_h "${attr} & 0x40")
+      math(EXPR flip_v "${attr} & 0x80")
+      if (flip_h)
+        string(APPEND attr_text "|OAM_FLIP_H")
+      endif()
+      if (flip_v)
+        string(APPEND attr_text "|OAM_FLIP_V")
+      endif()
+
+      # A blank line after every 4 sprites, like NEXXT does.
+      if (sprite GREATER 0)
+        math(EXPR group "${sprite} % 4")
+        if (group EQUAL 0)
+          string(APPEND text "\n")
+        endif()
+      endif()
+      string(APPEND text "\t${fields}${tile_hex},${attr_text},\n")
+      math(EXPR raw_size "${raw_size} + 4")
+    endforeach()
+    string(APPEND text "\t(int8_t)0x80\n\n};\n\n")
+    math(EXPR raw_size "${raw_size} + 1")
+
+    string(APPEND list_text "\t${bank}_${name}_data")
+    if (index LESS last)
+      string(APPEND list_text ",")
+    endif()
+    string(APPEND list_text "\n")
+  endforeach()
+  string(APPEND list_text "\n};\n\n")
+  string(APPEND text "${list_text}")
+  string(PREPEND text "// Generated from ${asset_name} by nss-convert.cmake, do not edit.\n\n")
+
+  # The data plus a pointer per metasprite in the list
+  math(EXPR rom_size "${raw_size} + ${count} * 2")
+
+else()
+  message(FATAL_ERROR "Unknown MODE ${MODE}")
+endif()
+
+file(WRITE ${OUTPUT} "${text}")
+file(WRITE ${SIZE_FILE} "${asset_name};${raw_size};${rom_size}\n")
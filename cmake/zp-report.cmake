@@ -0,0 +1,86 @@
+# Script mode helper that reports how the variables tagged with ZP_HOT ended up in the final ROM.
+#
+# Usage: cmake -DNM_BIN=<llvm-nm> -DOBJDUMP_BIN=<llvm-objdump> -DELF=<rom.nes.elf>
+#              -DSRC_DIR=<src> -DOUTPUT=<report.txt> -P zp-report.cmake
+#
+# For every ZP_HOT variable this finds its address in the linked ELF, and counts the instructions in
+# the disassembly that use zeropage addressing on it. A zeropage access is 1 byte smaller and (for
+# almost every instruction) 1 cycle faster than the absolute addressing it would use in regular RAM,
+# so the access count doubles as the estimated cycles saved each time all of that code runs once.
+
+if (NOT NM_BIN OR NOT OBJDUMP_BIN OR NOT ELF OR NOT SRC_DIR OR NOT OUTPUT)
+  message(FATAL_ERROR "NM_BIN, OBJDUMP_BIN, ELF, SRC_DIR and OUTPUT are required")
+endif()
+
+# Find the names of all the variables tagged with ZP_HOT in the source
+file(GLOB sources ${SRC_DIR}/*.cpp ${SRC_DIR}/*.hpp ${SRC_DIR}/*.c ${SRC_DIR}/*.h)
+set(hot_names)
+foreach(source ${sources})
+  file(READ ${source} text)
+  string(REGEX MATCHALL "ZP_HOT[^;(]*;" decls "${text}")
+  foreach(decl ${decls})
+    # Strip any initializer or array size, then the name is the last word left
+    string(REGEX REPLACE "[ \t]*[=\\[{;].*" "" decl "${decl}")
+    string(REGEX MATCH "[A-Za-z_][A-Za-z0-9_]*$" name "${decl}")
+    if (name AND NOT name STREQUAL "ZP_HOT")
+      list(APPEND hot_names ${name})
+    endif()
+  endforeach()
+endforeach()
+list(REMOVE_DUPLICATES hot_names)
+
+execute_process(COMMAND ${NM_BIN} --demangle --print-size --defined-only ${ELF} OUTPUT_VARIABLE symbols)
+execute_process(COMMAND ${OBJDUMP_BIN} -d --no-show-raw-insn ${ELF} OUTPUT_VARIABLE disasm)
+string(TOLOWER "${disasm}" disasm)
+
+set(report "Zeropage report for ${ELF}\n\n")
+string(APPEND report "variable                  addr  size\tzp accesses  est. cycles/bytes saved\n")
+set(total_accesses 0)
+foreach(name ${hot_names})
+  # nm lines look like `00000012 00000001 b pad`. LTO may add a `.llvm.1234` style suffix to the name.
+  string(REGEX MATCH "([0-9a-fA-F]+) ([0-9a-fA-F]+) [a-zA-Z] ${name}(\\.[^\n]*)?\n" line "${symbols}")
+  if (NOT line)
+    string(APPEND report "${name}: not found in the ROM (optimized away?)\n")
+    continue()
+  endif()
+  string(REGEX REPLACE "^([0-9a-fA-F]+) .*" "\\1" addr_hex "${line}")
+  string(REGEX REPLACE "^[0-9a-fA-F]+ ([0-9a-fA-F]+) .*" "\\1" size_hex "${line}")
+  math(EXPR addr "0x${addr_hex}")
+  math(EXPR size "0x${size_hex}")
+
+  if (addr GREATER_EQUAL 256)
+    string(APPEND report "${name}: tagged ZP_HOT but linked at ${addr_hex} which is NOT in zeropage\n")
+    continue()
+  endif()
+
+  # Count every instruction that addresses one of the variable's bytes through zeropage.
+  # Immediates (#$12) are skipped, and 4 digit operands are absolute addressing.
+  set(accesses 0)
+  math(EXPR last "${addr} + ${size} - 1")
+  foreach(byte RANGE ${addr} ${last})
+    math(EXPR byte_hex "${byte}" OUTPUT_FORMAT HEXADECIMAL)
+    string(REGEX REPLACE "^0x" "" byte_hex "${byte_hex}")
+    string(LENGTH "${byte_hex}" len)
+    if (len EQUAL 1)
+      set(byte_hex "0${byte_hex}")
+    endif()
+    string(REGEX MATCHALL "[ \t]\\$${byte_hex}(,[xy])?[ \t\n]" uses "${disasm}")
+    list(LENGTH uses count)
+    math(EXPR accesses "${accesses} + ${count}")
+  endforeach()
+  math(EXPR total_accesses "${total_accesses} + ${accesses}")
+
+  string(LENGTH "${name}" name_len)
+  math(EXPR pad_len "26 - ${name_len}")
+  if (pad_len LESS 1)
+    set(pad_len 1)
+  endif()
+  string(REPEAT " " ${pad_len} padding)
+  string(REGEX REPLACE "^0*([0-9a-fA-F][0-9a-fA-F])$" "\\1" short_addr "${addr_hex}")
+  string(APPEND report "${name}${padding}$${short_addr}   ${size}\t${accesses}\t     ~${accesses}\n")
+endforeach()
+string(APPEND report "\nTotal zeropage accesses to ZP_HOT variables: ${total_accesses} "
+                     "(~${total_accesses} cycles and bytes saved compared to regular RAM)\n")
+
+file(WRITE ${OUTPUT} "${report}")
+message(STATUS "${report}")
@@ -0,0 +1,34 @@
+-- Use this script with Mesen 2 on a build configured with -DLAG_PROFILE=On to count lag frames
+-- and the frames where the game skipped non-essential work to catch up.
+-- lag_frame_end() in src/lag.cpp writes to $401E once per frame: bit 0 is set if the frame ran over
+-- into the next one, bit 1 if the frame shed work.
+-- For example:
+--   $ mesen gg-llvm-mos-sample.nes lag-frames-mesen2.lua
+
+frames = 0
+lagged = 0
+shed = 0
+total_lagged = 0
+
+function cb(address, value)
+  frames = frames + 1
+  if ((value & 1) ~= 0) then
+    lagged = lagged + 1
+    total_lagged = total_lagged + 1
+  end
+  if ((value & 2) ~= 0) then
+    shed = shed + 1
+  end
+
+  -- Report about once a second
+  if (frames == 60) then
+    if (lagged ~= 0 or shed ~= 0) then
+      emu.log("lag frames: " .. lagged .. " shed frames: " .. shed .. " total lag frames: " .. total_lagged)
+    end
+    frames = 0
+    lagged = 0
+    shed = 0
+  end
+end
+
+emu.addMemoryCallback(cb, emu.callbackType.write, 0x401E)
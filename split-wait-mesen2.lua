@@ -0,0 +1,42 @@
+-- Use this script with Mesen 2 on a build configured with -DSPLIT_PROFILE=On to measure
+-- how many CPU cycles are spent busy waiting for the sprite zero split each frame.
+-- split_wait() in src/split.cpp writes a non-zero value to $401D right before it starts waiting and
+-- 0 right after the scroll has been changed, so the difference in the CPU cycle counter is the cost.
+-- Every cycle of the best case is time that could be spent on game logic before calling split_wait().
+-- For example:
+--   $ mesen gg-llvm-mos-sample.nes split-wait-mesen2.lua
+
+start_cycle = 0
+frames = 0
+total = 0
+best = nil
+worst = 0
+
+function cb(address, value)
+  cycle = emu.getState()["cpu.cycleCount"]
+  if (value ~= 0) then
+    start_cycle = cycle
+    return
+  end
+
+  cost = cycle - start_cycle
+  frames = frames + 1
+  total = total + cost
+  if (cost > worst) then
+    worst = cost
+  end
+  if (best == nil or cost < best) then
+    best = cost
+  end
+
+  -- Report about once a second
+  if (frames == 60) then
+    emu.log("split wait cycles avg: " .. math.floor(total / frames) .. " best: " .. best .. " worst: " .. worst)
+    frames = 0
+    total = 0
+    best = nil
+    worst = 0
+  end
+end
+
+emu.addMemoryCallback(cb, emu.callbackType.write, 0x401D)
@@ -0,0 +1,127 @@
+#include "anim.hpp"
+#include "clock.hpp"
+
+#include <cstdint>
+
+// Every animation used to be 2 frames of 0.1s each, keep that as the default timing.
+static constexpr uint8_t walk_durations[] = { SECONDS(0.1), SECONDS(0.1) };
+static constexpr uint8_t hold_durations[] = { ANIM_MAX_DURATION };
+
+static constexpr uint8_t player_idle_frames[] = { METASPR_PLAYER_IDLE };
+static constexpr uint8_t player_walk_frames[] = { METASPR_PLAYER_WALK_0, METASPR_PLAYER_WALK_1 };
+static constexpr uint8_t player_idle_left_frames[] = { METASPR_PLAYER_IDLE_LEFT };
+static constexpr uint8_t player_walk_left_frames[] = { METASPR_PLAYER_WALK_0_LEFT, METASPR_PLAYER_WALK_1_LEFT };
+static constexpr uint8_t bot_walk_frames[] = { METASPR_BOT_WALK_0, METASPR_BOT_WALK_1 };
+
+// Indexed by Anim_Clips, so keep it in the same order as the enum.
+static constexpr AnimClip anim_clips[ANIM_CLIP_COUNT] =
+{
+    // ANIM_NONE (never ticked or drawn, but keeps the lookups safe)
+    { player_idle_frames, hold_durations, 1, ANIM_ONCE },
+    // ANIM_PLAYER_IDLE
+    { player_idle_frames, hold_durations, 1, ANIM_ONCE },
+    // ANIM_PLAYER_WALK
+    { player_walk_frames, walk_durations, 2, ANIM_LOOP },
+    // ANIM_PLAYER_IDLE_LEFT
+    { player_idle_left_frames, hold_durations, 1, ANIM_ONCE },
+    // ANIM_PLAYER_WALK_LEFT
+    { player_walk_left_frames, walk_durations, 2, ANIM_LOOP },
+    // ANIM_BOT_WALK
+    { bot_walk_frames, walk_durations, 2, ANIM_LOOP },
+};
+
+consteval bool clips_fit_packed_state()
+{
+    for (const AnimClip& clip : anim_clips)
+    {
+        if (clip.length == 0 || clip.length > ANIM_MAX_FRAMES)
+        {
+            return false;
+        }
+        for (uint8_t i = 0; i < clip.length; ++i)
+        {
+            if (clip.durations[i] == 0 || clip.durations[i] > ANIM_MAX_DURATION)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+static_assert(clips_fit_packed_state(), "An animation clip has too many frames or a frame that's too long");
+
+static uint8_t frame_start(const AnimClip& clip, uint8_t frame)
+{
+    return (frame << ANIM_FRAME_SHIFT) | (clip.durations[frame] - 1);
+}
+
+static void tick(Entity& Object)
+{
+    if (Object.anim_clip == ANIM_NONE)
+    {
+        return;
+    }
+
+    // Most ticks only count down the timer.
+    if (Object.anim & ANIM_TIMER_MASK)
+    {
+        --Object.anim;
+        return;
+    }
+
+    const AnimClip& clip = anim_clips[Object.anim_clip];
+    uint8_t frame = (Object.anim >> ANIM_FRAME_SHIFT) + 1;
+    if (frame >= clip.length)
+    {
+        frame = (clip.loop == ANIM_LOOP) ? 0 : clip.length - 1;
+    }
+    Object.anim = frame_start(clip, frame);
+}
+
+void anim_play(Entity& Object, Anim_Clips clip)
+{
+    Object.anim_clip = clip;
+    Object.anim = frame_start(anim_clips[clip], 0);
+}
+
+void anim_set_clip(Entity& Object, Anim_Clips clip)
+{
+    if (Object.anim_clip == clip)
+    {
+        return;
+    }
+
+    Object.anim_clip = clip;
+    const AnimClip& new_clip = anim_clips[clip];
+    uint8_t frame = Object.anim >> ANIM_FRAME_SHIFT;
+    if (frame >= new_clip.length)
+    {
+        Object.anim = frame_start(new_clip, 0);
+        return;
+    }
+
+    // Keep the time already spent on the frame, but never wait longer than the new clip's frame lasts.
+    // Otherwise a long idle frame would hold up the first step of a walk.
+    uint8_t longest = frame_start(new_clip, frame);
+    if (Object.anim > longest)
+    {
+        Object.anim = longest;
+    }
+}
+
+void anim_tick_all()
+{
+    tick(p1);
+    for (uint8_t i = 0; i < NUM_ENTITIES; ++i)
+    {
+        if (ActiveEntities[i].cur_state != Entity_States::UNUSED)
+        {
+            tick(ActiveEntities[i]);
+        }
+    }
+}
+
+uint8_t anim_metasprite(const Entity& Object)
+{
+    return anim_clips[Object.anim_clip].metasprites[Object.anim >> ANIM_FRAME_SHIFT];
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "main.hpp"
+
+#include <cstdint>
+
+/**
+ * @brief Indices into `metaspr_list` (metasprites.h, generated from metaspr.nss). Keep in the same order as that list.
+ */
+enum Metasprites : uint8_t
+{
+    METASPR_BOX_16_16 = 0,
+    METASPR_BOT_WALK_0,
+    METASPR_BOT_WALK_1,
+    METASPR_PLAYER_WALK_0,
+    METASPR_PLAYER_WALK_1,
+    METASPR_PLAYER_IDLE,
+    METASPR_PLAYER_WALK_0_LEFT,
+    METASPR_PLAYER_WALK_1_LEFT,
+    METASPR_PLAYER_IDLE_LEFT,
+};
+
+/**
+ * @brief What happens after the last frame of a clip.
+ *        LOOP - start over from the first frame.
+ *        ONCE - stay on the last frame.
+ */
+enum Anim_Loop : uint8_t
+{
+    ANIM_LOOP = 0,
+    ANIM_ONCE,
+};
+
+/**
+ * @brief All of the animations in the game. ANIM_NONE is for entities that aren't animated,
+ *        they're skipped by the tick.
+ */
+enum Anim_Clips : uint8_t
+{
+    ANIM_NONE = 0,
+    ANIM_PLAYER_IDLE,
+    ANIM_PLAYER_WALK,
+    ANIM_PLAYER_IDLE_LEFT,
+    ANIM_PLAYER_WALK_LEFT,
+    ANIM_BOT_WALK,
+    ANIM_CLIP_COUNT,
+};
+
+/**
+ * @brief A list of metasprites to show and how many frames to show each for.
+ */
+struct AnimClip
+{
+    const uint8_t* metasprites;
+    const uint8_t* durations;
+    uint8_t length;
+    Anim_Loop loop;
+};
+
+/**
+ * @brief The animation state of an entity is packed into one byte: the current frame of the clip
+ *        in the top 3 bits, and the number of ticks left before the next frame in the bottom 5.
+ *        So a clip can have at most 8 frames, each lasting 1 - 32 ticks.
+ */
+constexpr uint8_t ANIM_FRAME_SHIFT = 5;
+constexpr uint8_t ANIM_TIMER_MASK = (1 << ANIM_FRAME_SHIFT) - 1;
+constexpr uint8_t ANIM_MAX_FRAMES = (0xff >> ANIM_FRAME_SHIFT) + 1;
+constexpr uint8_t ANIM_MAX_DURATION = ANIM_TIMER_MASK + 1;
+
+/**
+ * @brief Start a clip from the first frame.
+ */
+void anim_play(Entity& Object, Anim_Clips clip);
+
+/**
+ * @brief Switch to another clip without restarting it, as long as the current frame exists in the new clip.
+ *        Used for swapping between clips that line up frame by frame (like walking left and right).
+ *        The time left on the frame is cut down to the new clip's duration for it.
+ *        Does nothing if the clip is already playing.
+ */
+void anim_set_clip(Entity& Object, Anim_Clips clip);
+
+/**
+ * @brief Advance the animation of the player and every active entity by one frame. Call once per frame.
+ *        Most ticks are a single decrement, the clip table is only read when a frame ends.
+ */
+void anim_tick_all();
+
+/**
+ * @brief `metaspr_list` index of the frame the entity is showing.
+ */
+uint8_t anim_metasprite(const Entity& Object);
@@ -0,0 +1,192 @@
+#include "arena.hpp"
+#include "split.hpp"
+
+#if ARENA_SCROLL
+
+#include <cstdint>
+#include <neslib.h>
+
+// Include the VRAM buffer and the VRAM_INDEX so we can write directly into the buffer ourselves.
+extern volatile uint8_t VRAM_BUF[128];
+extern volatile __zeropage uint8_t VRAM_INDEX;
+extern volatile __zeropage uint8_t NAME_UPD_ENABLE;
+
+// Level data, one character per 8 pixel column. The pillars are only background decoration,
+// nothing collides with them.
+//   '|' - solid wall
+//   '.' - open floor
+//   'T' - pillar hanging down from the top
+//   'B' - pillar standing up from the bottom
+static constexpr char arena_layout[] =
+    "|..............T.........B..........T....B......"
+    "..B.......T.......B.........T.....T.........B..|";
+static_assert(sizeof(arena_layout) - 1 == ARENA_COLUMNS, "arena_layout must be ARENA_COLUMNS long");
+
+constexpr uint8_t PILLAR_HEIGHT = 6;
+
+// The two nametables hold this many columns, the rest of the arena gets streamed in.
+constexpr uint8_t RING_COLUMNS = 64;
+// Extra columns kept loaded on each side of the screen, so a fast camera can't outrun the streamer.
+constexpr uint8_t STREAM_MARGIN = 8;
+
+uint16_t camera_x;
+
+// Columns [loaded_lo, loaded_hi) are currently in the nametables.
+static uint8_t loaded_lo;
+static uint8_t loaded_hi;
+
+static uint8_t column_tile(char type, uint8_t row)
+{
+    switch (type)
+    {
+        case '|':
+            return 0x0f;
+        case 'T':
+            return (row < PILLAR_HEIGHT) ? 0x0f : 0x00;
+        case 'B':
+            return (row >= ARENA_ROWS - PILLAR_HEIGHT) ? 0x0f : 0x00;
+        default:
+            return 0x00;
+    }
+}
+
+static uint16_t column_ppu_addr(uint8_t column)
+{
+    // Columns 0 - 31 of the ring are in nametable A, 32 - 63 are in nametable B.
+    uint16_t base = (column & 0x20) ? NAMETABLE_B : NAMETABLE_A;
+    return base + (ARENA_TOP_ROW << 5) + (column & 0x1f);
+}
+
+// Queue a column as a single vertical run. Returns false if it doesn't fit in the VRAM_BUF this frame.
+static bool queue_column(uint8_t column)
+{
+    uint8_t idx = VRAM_INDEX;
+    if (idx > 127 - ARENA_STREAM_COST)
+    {
+        return false;
+    }
+
+    uint16_t ppuaddr = column_ppu_addr(column);
+    char type = arena_layout[column];
+    VRAM_BUF[idx++] = MSB(ppuaddr) | NT_UPD_VERT;
+    VRAM_BUF[idx++] = LSB(ppuaddr);
+    VRAM_BUF[idx++] = ARENA_ROWS;
+    for (uint8_t row = 0; row < ARENA_ROWS; ++row)
+    {
+        VRAM_BUF[idx++] = column_tile(type, row);
+    }
+    VRAM_BUF[idx] = NT_UPD_EOF;
+    VRAM_INDEX = idx;
+    NAME_UPD_ENABLE = true;
+    return true;
+}
+
+static void clear_nametable(uint16_t base)
+{
+    // Wall along the top and bottom row, the HUD rows and the playfield start out empty.
+    vram_adr(base);
+    vram_fill(0x0f, 32);
+    vram_fill(0x00, 28 * 32);
+    vram_fill(0x0f, 32);
+    // Attributes
+    vram_fill(0x00, 64);
+}
+
+// The top HUD rows never scroll, so frame them with the side walls. The right wall also gives
+// sprite 0 the opaque background pixel it needs for the split.
+static void draw_hud_walls()
+{
+    for (uint8_t row = 1; row < ARENA_TOP_ROW; ++row)
+    {
+        vram_adr(NTADR_A(0, row));
+        vram_put(0x0f);
+        vram_adr(NTADR_A(31, row));
+        vram_put(0x0f);
+    }
+}
+
+void arena_init()
+{
+    clear_nametable(NAMETABLE_A);
+    clear_nametable(NAMETABLE_B);
+    draw_hud_walls();
+
+    camera_x = 0;
+    loaded_lo = 0;
+    loaded_hi = MMIN(RING_COLUMNS, ARENA_COLUMNS);
+
+    // Write the first ring's worth of columns straight to the PPU, top to bottom.
+    vram_inc(1);
+    for (uint8_t column = loaded_lo; column < loaded_hi; ++column)
+    {
+        char type = arena_layout[column];
+        vram_adr(column_ppu_addr(column));
+        for (uint8_t row = 0; row < ARENA_ROWS; ++row)
+        {
+            vram_put(column_tile(type, row));
+        }
+    }
+    vram_inc(0);
+
+    // The HUD above the playfield is drawn with the NMI scroll and the playfield below the split.
+    scroll(0, 0);
+    split_enable(ARENA_TOP_ROW * 8 - 1);
+    split_set_scroll(0);
+}
+
+void arena_update()
+{
+    // Keep the player centered, but don't show anything past the ends of the arena.
+    int16_t target = (int16_t)p1.x.as_i() + 8 - 128;
+    if (target < 0)
+    {
+        target = 0;
+    }
+    else if (target > ARENA_WIDTH - 256)
+    {
+        target = ARENA_WIDTH - 256;
+    }
+    camera_x = (uint16_t)target;
+
+    // Stream at most one column per frame so the cost is fixed. The camera can't move more than
+    // a couple of pixels per frame, so this easily keeps ahead of it.
+    uint8_t camera_column = (uint8_t)(camera_x >> 3);
+    uint8_t want_lo = (camera_column > STREAM_MARGIN) ? camera_column - STREAM_MARGIN : 0;
+    uint8_t want_hi = MMIN((uint8_t)(camera_column + 33 + STREAM_MARGIN), ARENA_COLUMNS);
+
+    if (loaded_hi < want_hi)
+    {
+        if (queue_column(loaded_hi))
+        {
+            // The new column replaces the one a full ring to the left of it.
+            ++loaded_hi;
+            if (loaded_hi - loaded_lo > RING_COLUMNS)
+            {
+                ++loaded_lo;
+            }
+        }
+    }
+    else if (loaded_lo > want_lo)
+    {
+        if (queue_column(loaded_lo - 1))
+        {
+            --loaded_lo;
+            if (loaded_hi - loaded_lo > RING_COLUMNS)
+            {
+                --loaded_hi;
+            }
+        }
+    }
+
+    // Bit 8 of the scroll picks the nametable, which lines up with the ring layout.
+    split_set_scroll(camera_x & 0x1ff);
+}
+
+void arena_reset_camera()
+{
+    camera_x = 0;
+    split_disable();
+    scroll(0, 0);
+}
+
+#endif
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "main.hpp"
+
+#include <cstdint>
+
+/**
+ * @brief Horizontally scrolling arena (ARENA_SCROLL, set from CMakeLists.txt).
+ *
+ *        Nametable A and B sit side by side (vertical mirroring), giving a 64 column ring that the
+ *        arena is streamed into one 8 pixel column at a time as the camera follows the player.
+ *        Only the playfield rows are streamed. The HUD rows above and below are left alone, and the top HUD
+ *        stays still thanks to a sprite zero split (split.hpp) at the top of the playfield. The rows below scroll
+ *        along with the playfield, so anything that has to stay on screen goes in the top HUD.
+ *
+ *        With ARENA_SCROLL off the arena is the single gameplay screen, `camera_x` is a constant 0,
+ *        and the helpers below fold away to the plain screen coordinates the game always used.
+ */
+
+// Nametable rows that the streamer writes. Rows outside of this range belong to the HUD.
+constexpr uint8_t ARENA_TOP_ROW = 5;
+constexpr uint8_t ARENA_BOTTOM_ROW = 25;
+constexpr uint8_t ARENA_ROWS = ARENA_BOTTOM_ROW - ARENA_TOP_ROW + 1;
+
+#if ARENA_SCROLL
+// Width of the arena in 8 pixel columns. Must match the length of `arena_layout` in arena.cpp.
+constexpr uint8_t ARENA_COLUMNS = 96;
+constexpr int16_t ARENA_WIDTH = ARENA_COLUMNS * 8;
+
+// World x of the left edge of the screen.
+extern uint16_t camera_x;
+#else
+constexpr int16_t ARENA_WIDTH = 256;
+constexpr uint16_t camera_x = 0;
+#endif
+
+/**
+ * @brief Worst case number of VRAM_BUF bytes the column streamer uses in a frame (one vertical packet).
+ */
+constexpr uint8_t ARENA_STREAM_COST = 3 + ARENA_ROWS;
+
+#if ARENA_SCROLL
+
+/**
+ * @brief Draw the arena around the start position into both nametables and reset the camera.
+ *        Rendering must be OFF.
+ */
+void arena_init();
+
+/**
+ * @brief Move the camera towards the player, queue at most one new column into the VRAM_BUF and set the scroll
+ *        for the playfield below the sprite zero split.
+ *        Call once per frame during gameplay, after the player has moved.
+ */
+void arena_update();
+
+/**
+ * @brief Put the camera back at the left edge of the arena and the scroll back to 0, 0 for the non-arena screens.
+ */
+void arena_reset_camera();
+
+#else
+
+// The single screen arena is loaded by the gameplay state itself and never scrolls.
+inline void arena_update() {}
+inline void arena_reset_camera() {}
+
+#endif
+
+/**
+ * @brief Convert a world x position into a screen x position for drawing.
+ *
+ * @param world_x - left edge of the object in the world
+ * @param width - width of the object in pixels
+ * @param screen_x - set to the screen position of the left edge
+ * @return false if any part of the object is off screen and it shouldn't be drawn
+ */
+inline bool arena_to_screen(uint16_t world_x, uint8_t width, uint8_t& screen_x)
+{
+    uint16_t x = world_x - camera_x;
+    screen_x = (uint8_t)x;
+    return x <= (uint16_t)(256 - width);
+}
@@ -0,0 +1,75 @@
+#include "audio.hpp"
+
+#if AUDIO_ENABLED
+
+#include <cstdint>
+#include <famitone2.h>
+
+// Generated from audio/music.txt at build time, and written by hand in ca65/audio.s
+extern "C" const uint8_t famitone_music_data[];
+extern "C" const uint8_t famitone_sfx_data[];
+
+// Defined in ca65/audio.s, the NMI hook skips the update until this is set.
+extern "C" volatile uint8_t audio_ready;
+
+// FamiTone2 has no priorities of its own, separate streams are mixed by volume. So every effect plays on
+// the same stream, and a new effect only replaces the one playing if it's at least as important.
+constexpr uint8_t SFX_STREAM = 0;
+
+struct SfxInfo
+{
+    // Higher wins
+    uint8_t priority;
+    // How long the effect in ca65/audio.s lasts, in frames
+    uint8_t frames;
+};
+
+static const SfxInfo sfx_info[SFX_COUNT] =
+{
+    { 1,  6 }, // SFX_SHOT
+    { 2, 11 }, // SFX_HIT
+    { 0, 14 }, // SFX_PICKUP
+};
+
+// The effect playing right now, and how many frames it still has to go. 0 when the stream is quiet.
+static uint8_t playing_priority;
+static uint8_t playing_frames;
+
+void audio_init()
+{
+    famitone_init(famitone_music_data);
+    sfx_init(famitone_sfx_data);
+    audio_ready = 1;
+}
+
+void audio_play_song(Songs song)
+{
+    music_play(song);
+}
+
+void audio_stop_song()
+{
+    music_stop();
+}
+
+void audio_play_sfx(Sfx sfx)
+{
+    const SfxInfo& info = sfx_info[sfx];
+    if (playing_frames != 0 && info.priority < playing_priority)
+    {
+        return;
+    }
+    sfx_play(sfx, SFX_STREAM);
+    playing_priority = info.priority;
+    playing_frames = info.frames;
+}
+
+void audio_update()
+{
+    if (playing_frames != 0)
+    {
+        --playing_frames;
+    }
+}
+
+#endif
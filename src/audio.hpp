@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Songs in `audio/music.txt`, in the same order as the tracks in the FamiTracker module.
+ */
+enum Songs : uint8_t
+{
+    SONG_TITLE = 0,
+    SONG_GAMEPLAY,
+};
+
+/**
+ * @brief Sound effects defined in `ca65/audio.s`, in the same order as the effect table there.
+ */
+enum Sfx : uint8_t
+{
+    SFX_SHOT = 0,
+    SFX_HIT,
+    SFX_PICKUP,
+    SFX_COUNT,
+};
+
+/**
+ * @brief Rough worst case cost of one FamiTone2 update (music + all sfx streams) in CPU cycles.
+ *        This runs at the end of NMI every frame, so it comes straight out of the ~29780 cycles
+ *        we have per NTSC frame. Build with `AUDIO_PROFILE` and load `audio-cycles-mesen2.lua` from the
+ *        build folder in Mesen, it logs every update that goes over this. Raise it only if the music
+ *        really needs it. CMake reads the value from this line, so keep it a plain number.
+ */
+constexpr uint16_t AUDIO_CYCLE_BUDGET = 1500;
+
+#if AUDIO_ENABLED
+
+/**
+ * @brief Initialize FamiTone2 with our music and sfx data and start running the update in NMI.
+ */
+void audio_init();
+
+void audio_play_song(Songs song);
+void audio_stop_song();
+
+/**
+ * @brief Play a sound effect. Only one effect plays at a time, and each has a priority in `audio.cpp`
+ *        (hit over shot over pickup). The new effect replaces the one playing, unless that one is more
+ *        important and hasn't finished yet, then the new one is dropped.
+ */
+void audio_play_sfx(Sfx sfx);
+
+/**
+ * @brief Count down the effect that's playing. Call once per frame.
+ */
+void audio_update();
+
+#else
+
+// Audio was compiled out (text2data wasn't found), so these all turn into nothing.
+inline void audio_init() {}
+inline void audio_play_song(Songs) {}
+inline void audio_stop_song() {}
+inline void audio_play_sfx(Sfx) {}
+inline void audio_update() {}
+
+#endif
@@ -0,0 +1,109 @@
+#include "big_digits.hpp"
+
+#include <cstdint>
+#include <nesdoug.h>
+#include <neslib.h>
+#include <soa.h>
+
+#include "metatile.hpp"
+
+__attribute__((section(".prg_rom_fixed")))
+static const constexpr soa::Array<Metatile_4_4, 10> big_digits = {
+    #include "big_digits.inc"
+};
+
+// Include the VRAM buffer and the VRAM_INDEX so we can write directly into the buffer ourselves.
+extern volatile uint8_t VRAM_BUF[128];
+extern volatile __zeropage uint8_t VRAM_INDEX;
+extern volatile __zeropage uint8_t NAME_UPD_ENABLE;
+
+// Digits are never bigger than 9, so this always counts as changed.
+static constexpr uint8_t DIGIT_UNKNOWN = 0xff;
+
+void big_number_init(BigNumber& number, Nametable nmt, uint8_t x, uint8_t y, uint8_t digit_count)
+{
+    number.nmt = nmt;
+    number.x = x;
+    number.y = y;
+    number.digit_count = digit_count;
+    for (uint8_t i = 0; i < BIG_NUMBER_MAX_DIGITS; ++i)
+    {
+        number.shown[i] = DIGIT_UNKNOWN;
+    }
+}
+
+uint8_t big_number_update(BigNumber& number, uint16_t value)
+{
+    uint8_t digits[BIG_NUMBER_MAX_DIGITS];
+    for (uint8_t i = number.digit_count; i-- != 0;)
+    {
+        digits[i] = (uint8_t)(value % 10);
+        value /= 10;
+    }
+
+    uint8_t first = number.digit_count;
+    uint8_t last = 0;
+    for (uint8_t i = 0; i < number.digit_count; ++i)
+    {
+        if (digits[i] != number.shown[i])
+        {
+            if (first == number.digit_count)
+            {
+                first = i;
+            }
+            last = i;
+        }
+    }
+    if (first == number.digit_count)
+    {
+        return 0;
+    }
+
+    uint8_t span = last - first + 1;
+    uint8_t cost = big_number_vram_cost(span);
+    uint8_t idx = VRAM_INDEX;
+    // Room for the runs and the end marker
+    if (idx + cost > 127)
+    {
+        return 0;
+    }
+
+    // The 4 row headers, then each digit writes its 4 tiles into every row.
+    uint8_t row_size = 3 + 4 * span;
+    uint16_t ppuaddr = 0x2000 | (((uint8_t)number.nmt) << 8) | (number.y << 5) | (number.x + first * 4);
+    for (uint8_t row = 0; row < 4; ++row)
+    {
+        uint8_t at = idx + row * row_size;
+        VRAM_BUF[at + 0] = MSB(ppuaddr) | NT_UPD_HORZ;
+        VRAM_BUF[at + 1] = LSB(ppuaddr);
+        VRAM_BUF[at + 2] = 4 * span;
+        ppuaddr += 32;
+    }
+
+    uint8_t at = idx + 3;
+    for (uint8_t i = first; i <= last; ++i)
+    {
+        const Metatile_4_4 glyph = big_digits[digits[i]].get();
+        const uint8_t rows[4][2] = {
+            { glyph.topleft.top, glyph.topright.top },
+            { glyph.topleft.bot, glyph.topright.bot },
+            { glyph.botleft.top, glyph.botright.top },
+            { glyph.botleft.bot, glyph.botright.bot },
+        };
+        for (uint8_t row = 0; row < 4; ++row)
+        {
+            uint8_t tile_at = at + row * row_size;
+            VRAM_BUF[tile_at + 0] = LEFT_TILE(rows[row][0]);
+            VRAM_BUF[tile_at + 1] = RIGHT_TILE(rows[row][0]);
+            VRAM_BUF[tile_at + 2] = LEFT_TILE(rows[row][1]);
+            VRAM_BUF[tile_at + 3] = RIGHT_TILE(rows[row][1]);
+        }
+        at += 4;
+        number.shown[i] = digits[i];
+    }
+
+    VRAM_BUF[idx + cost] = NT_UPD_EOF;
+    VRAM_INDEX = idx + cost;
+    NAME_UPD_ENABLE = true;
+    return cost;
+}
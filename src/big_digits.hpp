@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+#include "metatile.hpp"
+
+/**
+ * @brief Large 4x4 tile digits (see big_digits.inc) for showing a number in the HUD.
+ *
+ *        A `BigNumber` remembers which digits are on screen, and `big_number_update` only redraws the ones that
+ *        changed. All the changed digits go out together as 4 horizontal runs in VRAM_BUF, one per tile row,
+ *        from the first changed digit to the last. Going through `draw_metatile_4_4` instead would be 8 vertical
+ *        runs of 2 tiles for every digit.
+ *
+ *        VRAM_BUF bytes, and NMI cycles estimated with the stock cost per run and per tile from vram_fast.hpp:
+ *
+ *                          bytes    NMI cycles    with draw_metatile_4_4
+ *          1 digit           28        ~540              ~820
+ *          2 digits          44        ~800             ~1650
+ *          3 digits          60       ~1050             ~2470
+ *
+ *        Adding 1 to a score usually only changes the last digit.
+ */
+
+/**
+ * @brief Most digits a `BigNumber` can have. 4 tiles each, so 8 would be the whole width of the screen.
+ */
+constexpr uint8_t BIG_NUMBER_MAX_DIGITS = 5;
+
+/**
+ * @brief VRAM_BUF bytes for redrawing `span` digits next to each other, not counting the end marker.
+ */
+constexpr uint8_t big_number_vram_cost(uint8_t span)
+{
+    return 4 * (3 + 4 * span);
+}
+
+static_assert(big_number_vram_cost(BIG_NUMBER_MAX_DIGITS) + 1 <= 128, "A full redraw has to fit in VRAM_BUF");
+
+struct BigNumber
+{
+    Nametable nmt;
+    uint8_t x;
+    uint8_t y;
+    uint8_t digit_count;
+    // What's on screen right now, most significant digit first
+    uint8_t shown[BIG_NUMBER_MAX_DIGITS];
+};
+
+/**
+ * @brief Set up a number at tile x, y, `digit_count` digits wide with leading zeros. Nothing is drawn until
+ *        the first `big_number_update`, which draws every digit.
+ */
+void big_number_init(BigNumber& number, Nametable nmt, uint8_t x, uint8_t y, uint8_t digit_count);
+
+/**
+ * @brief Queue a redraw of the digits that changed since the last update. If they don't fit in VRAM_BUF this
+ *        frame nothing is queued, so keep calling it every frame and the redraw goes out once there's room.
+ *
+ * @return the VRAM_BUF bytes used, 0 if nothing changed or it didn't fit
+ */
+uint8_t big_number_update(BigNumber& number, uint16_t value);
@@ -0,0 +1,340 @@
+#include "canvas.hpp"
+
+#include <cstdint>
+#include <neslib.h>
+
+// Include the VRAM buffer and the VRAM_INDEX so we can write directly into the buffer ourselves.
+extern volatile uint8_t VRAM_BUF[128];
+extern volatile __zeropage uint8_t VRAM_INDEX;
+extern volatile __zeropage uint8_t NAME_UPD_ENABLE;
+
+// Quadrant tile index for every 2x2 pixel combination, in the same tl tr bl br bit order
+// that the metatile string parser uses.
+static constexpr uint8_t quadrant_tiles[16] = {
+    get_tile_for_bits(0x0), get_tile_for_bits(0x1), get_tile_for_bits(0x2), get_tile_for_bits(0x3),
+    get_tile_for_bits(0x4), get_tile_for_bits(0x5), get_tile_for_bits(0x6), get_tile_for_bits(0x7),
+    get_tile_for_bits(0x8), get_tile_for_bits(0x9), get_tile_for_bits(0xa), get_tile_for_bits(0xb),
+    get_tile_for_bits(0xc), get_tile_for_bits(0xd), get_tile_for_bits(0xe), get_tile_for_bits(0xf),
+};
+
+// 1 bit per pixel, the leftmost pixel of each byte is the high bit.
+static uint8_t bitmap[CANVAS_HEIGHT][CANVAS_WIDTH / 8];
+// 1 bit per tile that still needs to be sent to the PPU, same bit order as the bitmap.
+static uint8_t dirty[CANVAS_TILE_ROWS][CANVAS_TILE_COLS / 8];
+static bool any_dirty;
+
+static Nametable canvas_nmt;
+// Row the next flush starts from, so a busy area at the top can't starve the rows below it.
+static uint8_t flush_row;
+
+static void mark_dirty(uint8_t tx, uint8_t ty)
+{
+    dirty[ty][tx >> 3] |= 0x80 >> (tx & 7);
+    any_dirty = true;
+}
+
+// Write a whole bitmap byte and mark the (up to 4) tiles whose pixels changed.
+static void store_byte(uint8_t y, uint8_t col, uint8_t value)
+{
+    uint8_t changed = bitmap[y][col] ^ value;
+    if (changed == 0)
+    {
+        return;
+    }
+    bitmap[y][col] = value;
+
+    uint8_t tx = col * 4;
+    for (uint8_t mask = 0xc0; mask != 0; mask >>= 2, ++tx)
+    {
+        if (changed & mask)
+        {
+            mark_dirty(tx, y >> 1);
+        }
+    }
+}
+
+// Set or clear pixels x0 to x1 (inclusive) of a row, a byte at a time. Coordinates must already be clipped.
+static void fill_span(uint8_t x0, uint8_t x1, uint8_t y, bool on)
+{
+    uint8_t first = x0 >> 3;
+    uint8_t last = x1 >> 3;
+    for (uint8_t col = first; col <= last; ++col)
+    {
+        uint8_t mask = 0xff;
+        if (col == first)
+        {
+            mask &= 0xff >> (x0 & 7);
+        }
+        if (col == last)
+        {
+            mask &= 0xff << (7 - (x1 & 7));
+        }
+        uint8_t byte = bitmap[y][col];
+        store_byte(y, col, on ? (byte | mask) : (byte & ~mask));
+    }
+}
+
+static uint8_t tile_at(uint8_t tx, uint8_t ty)
+{
+    uint8_t shift = 6 - ((tx & 3) << 1);
+    uint8_t top = (bitmap[ty * 2][tx >> 2] >> shift) & 3;
+    uint8_t bot = (bitmap[ty * 2 + 1][tx >> 2] >> shift) & 3;
+    return quadrant_tiles[(top << 2) | bot];
+}
+
+static bool is_tile_dirty(uint8_t tx, uint8_t ty)
+{
+    return dirty[ty][tx >> 3] & (0x80 >> (tx & 7));
+}
+
+void canvas_init(Nametable nmt)
+{
+    canvas_nmt = nmt;
+    flush_row = 0;
+    any_dirty = false;
+    for (uint8_t y = 0; y < CANVAS_HEIGHT; ++y)
+    {
+        for (uint8_t col = 0; col < CANVAS_WIDTH / 8; ++col)
+        {
+            bitmap[y][col] = 0;
+        }
+    }
+    for (uint8_t ty = 0; ty < CANVAS_TILE_ROWS; ++ty)
+    {
+        for (uint8_t col = 0; col < CANVAS_TILE_COLS / 8; ++col)
+        {
+            dirty[ty][col] = 0;
+        }
+    }
+}
+
+void canvas_clear()
+{
+    for (uint8_t y = 0; y < CANVAS_HEIGHT; ++y)
+    {
+        for (uint8_t col = 0; col < CANVAS_WIDTH / 8; ++col)
+        {
+            store_byte(y, col, 0);
+        }
+    }
+}
+
+bool canvas_get(uint8_t x, uint8_t y)
+{
+    if (x >= CANVAS_WIDTH || y >= CANVAS_HEIGHT)
+    {
+        return false;
+    }
+    return bitmap[y][x >> 3] & (0x80 >> (x & 7));
+}
+
+void canvas_plot(uint8_t x, uint8_t y, bool on)
+{
+    if (x >= CANVAS_WIDTH || y >= CANVAS_HEIGHT)
+    {
+        return;
+    }
+    uint8_t mask = 0x80 >> (x & 7);
+    uint8_t byte = bitmap[y][x >> 3];
+    uint8_t updated = on ? (byte | mask) : (byte & ~mask);
+    if (updated != byte)
+    {
+        bitmap[y][x >> 3] = updated;
+        mark_dirty(x >> 1, y >> 1);
+    }
+}
+
+void canvas_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool on)
+{
+    // Bresenham. The endpoints can be anywhere in 0 - 255, so the deltas and the error term (up to twice
+    // the sum of the deltas) need 16 bits. Points that land outside of the canvas are dropped by canvas_plot.
+    int16_t dx = (x1 > x0) ? (int16_t)(x1 - x0) : (int16_t)(x0 - x1);
+    int16_t dy = (y1 > y0) ? -(int16_t)(y1 - y0) : -(int16_t)(y0 - y1);
+    int8_t step_x = (x0 < x1) ? 1 : -1;
+    int8_t step_y = (y0 < y1) ? 1 : -1;
+    int16_t err = dx + dy;
+
+    while (true)
+    {
+        canvas_plot(x0, y0, on);
+        if (x0 == x1 && y0 == y1)
+        {
+            break;
+        }
+        int16_t e2 = err * 2;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x0 += step_x;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y0 += step_y;
+        }
+    }
+}
+
+void canvas_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, bool on)
+{
+    if (x >= CANVAS_WIDTH || y >= CANVAS_HEIGHT || w == 0 || h == 0)
+    {
+        return;
+    }
+    if (w > CANVAS_WIDTH - x)
+    {
+        w = CANVAS_WIDTH - x;
+    }
+    if (h > CANVAS_HEIGHT - y)
+    {
+        h = CANVAS_HEIGHT - y;
+    }
+    uint8_t x1 = x + w - 1;
+    for (uint8_t row = y; row < y + h; ++row)
+    {
+        fill_span(x, x1, row, on);
+    }
+}
+
+void canvas_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, bool on)
+{
+    if (w == 0 || h == 0)
+    {
+        return;
+    }
+    canvas_fill_rect(x, y, w, 1, on);
+    canvas_fill_rect(x, y, 1, h, on);
+    // The right and bottom edges can start past the end of the canvas, fill_rect clips those.
+    if ((uint16_t)y + h - 1 < CANVAS_HEIGHT)
+    {
+        canvas_fill_rect(x, y + h - 1, w, 1, on);
+    }
+    if ((uint16_t)x + w - 1 < CANVAS_WIDTH)
+    {
+        canvas_fill_rect(x + w - 1, y, 1, h, on);
+    }
+}
+
+void canvas_blit(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* bits)
+{
+    uint8_t stride = (w + 7) >> 3;
+    for (uint8_t row = 0; row < h; ++row)
+    {
+        const uint8_t* src = bits + row * stride;
+        uint8_t mask = 0x80;
+        for (uint8_t col = 0; col < w; ++col)
+        {
+            canvas_plot(x + col, y + row, *src & mask);
+            mask >>= 1;
+            if (mask == 0)
+            {
+                mask = 0x80;
+                ++src;
+            }
+        }
+    }
+}
+
+bool canvas_is_dirty()
+{
+    return any_dirty;
+}
+
+bool canvas_flush(uint8_t budget)
+{
+    if (!any_dirty)
+    {
+        return true;
+    }
+
+    // Always leave room for the terminator byte.
+    uint8_t idx = VRAM_INDEX;
+    if (budget > 127 - idx)
+    {
+        budget = 127 - idx;
+    }
+
+    bool out_of_space = false;
+    for (uint8_t rows_checked = 0; rows_checked < CANVAS_TILE_ROWS && !out_of_space; ++rows_checked)
+    {
+        uint8_t ty = flush_row;
+        const uint8_t* row_dirty = dirty[ty];
+        if (row_dirty[0] | row_dirty[1] | row_dirty[2] | row_dirty[3])
+        {
+            uint8_t tx = 0;
+            while (tx < CANVAS_TILE_COLS)
+            {
+                if (!is_tile_dirty(tx, ty))
+                {
+                    ++tx;
+                    continue;
+                }
+
+                uint8_t end = tx + 1;
+                while (end < CANVAS_TILE_COLS && is_tile_dirty(end, ty))
+                {
+                    ++end;
+                }
+
+                // A single tile uses the 3 byte packet, longer runs have a length byte too.
+                uint8_t len = end - tx;
+                uint8_t cost = (len == 1) ? 3 : 3 + len;
+                if (cost > budget)
+                {
+                    if (budget < 3)
+                    {
+                        out_of_space = true;
+                        break;
+                    }
+                    // Send as much of the run as still fits, the rest stays dirty.
+                    len = (budget == 3) ? 1 : budget - 3;
+                    end = tx + len;
+                    cost = (len == 1) ? 3 : 3 + len;
+                    out_of_space = true;
+                }
+                budget -= cost;
+
+                uint16_t ppuaddr = 0x2000 | (((uint8_t)canvas_nmt) << 8) | (ty << 5) | tx;
+                if (len == 1)
+                {
+                    VRAM_BUF[idx++] = MSB(ppuaddr);
+                    VRAM_BUF[idx++] = LSB(ppuaddr);
+                }
+                else
+                {
+                    VRAM_BUF[idx++] = MSB(ppuaddr) | NT_UPD_HORZ;
+                    VRAM_BUF[idx++] = LSB(ppuaddr);
+                    VRAM_BUF[idx++] = len;
+                }
+                for (; tx < end; ++tx)
+                {
+                    VRAM_BUF[idx++] = tile_at(tx, ty);
+                    dirty[ty][tx >> 3] &= ~(0x80 >> (tx & 7));
+                }
+
+                if (out_of_space)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (!out_of_space || !(row_dirty[0] | row_dirty[1] | row_dirty[2] | row_dirty[3]))
+        {
+            flush_row = (ty + 1 == CANVAS_TILE_ROWS) ? 0 : ty + 1;
+        }
+    }
+
+    if (idx != VRAM_INDEX)
+    {
+        VRAM_BUF[idx] = NT_UPD_EOF;
+        VRAM_INDEX = idx;
+        NAME_UPD_ENABLE = true;
+    }
+
+    if (!out_of_space)
+    {
+        any_dirty = false;
+    }
+    return !out_of_space;
+}
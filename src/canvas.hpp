@@ -0,0 +1,70 @@
+#pragma once
+
+#include "metatile.hpp"
+
+#include <cstdint>
+
+/**
+ * @brief A 64x60 "fat pixel" canvas that covers a whole nametable. Every tile on screen shows 2x2 canvas
+ *        pixels using one of the 16 quadrant tiles from the Game Genie CHR, so the canvas only needs
+ *        1 bit per pixel (480 bytes of RAM) instead of a full nametable per picture.
+ *
+ *        Drawing only touches the bitmap and remembers which tiles changed. `canvas_flush` then converts
+ *        the changed tiles into quadrant tile indices and queues them into the VRAM_BUF, so it's safe
+ *        to draw with rendering ON.
+ */
+constexpr uint8_t CANVAS_WIDTH = 64;
+constexpr uint8_t CANVAS_HEIGHT = 60;
+
+constexpr uint8_t CANVAS_TILE_COLS = CANVAS_WIDTH / 2;
+constexpr uint8_t CANVAS_TILE_ROWS = CANVAS_HEIGHT / 2;
+
+/**
+ * @brief Default number of VRAM_BUF bytes `canvas_flush` may use in a single frame.
+ *        The VRAM_BUF is shared with the text renderer and the HUD, so don't let the canvas take all of it.
+ *        Whatever doesn't fit is left dirty and sent on the next flush.
+ */
+constexpr uint8_t CANVAS_VRAM_BUDGET = 64;
+
+/**
+ * @brief Select the nametable the canvas is shown in and clear the bitmap.
+ *        Nothing is marked dirty, so the nametable is expected to already be blank (all tile 0).
+ */
+void canvas_init(Nametable nmt);
+
+/**
+ * @brief Clear every pixel, only the tiles that weren't already blank are marked dirty.
+ */
+void canvas_clear();
+
+bool canvas_get(uint8_t x, uint8_t y);
+
+/**
+ * @brief Drawing primitives. Coordinates outside of the canvas are clipped.
+ *
+ * @param on - true sets the pixels, false clears them
+ */
+void canvas_plot(uint8_t x, uint8_t y, bool on = true);
+void canvas_line(uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool on = true);
+void canvas_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, bool on = true);
+void canvas_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, bool on = true);
+
+/**
+ * @brief Copy a 1 bit per pixel image onto the canvas. Each row of the image starts on a new byte
+ *        and the leftmost pixel is the high bit. The image is opaque, 0 bits clear the canvas pixel.
+ */
+void canvas_blit(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_t* bits);
+
+/**
+ * @brief True if any tile changed since it was last sent to the PPU.
+ */
+bool canvas_is_dirty();
+
+/**
+ * @brief Queue the changed tiles into the VRAM_BUF. Call once per frame while the canvas is on screen.
+ *        Neighbouring dirty tiles in a row are sent as one horizontal run to keep the buffer overhead down.
+ *
+ * @param budget - max number of VRAM_BUF bytes to use this frame
+ * @return true if every dirty tile was queued, false if some are left over for the next frame
+ */
+bool canvas_flush(uint8_t budget = CANVAS_VRAM_BUDGET);
@@ -0,0 +1,67 @@
+#include "canvas_check.hpp"
+
+#if CANVAS_CHECK
+
+#include <cstdint>
+#include <cstdio>
+
+#include "canvas.hpp"
+
+struct LineCase
+{
+    uint8_t x0, y0, x1, y1;
+    // How many pixels end up on the canvas, and one of them.
+    uint8_t pixels;
+    uint8_t px, py;
+};
+
+// Lines that stay on the canvas, and lines that leave it far enough to overflow 8 bit deltas.
+static constexpr LineCase lines[] =
+{
+    {   5,   5,   5,   5,  1,  5,  5 },
+    {   0,   0,  63,  59, 64, 63, 59 },
+    {   0,   0, 200,   0, 64, 63,  0 },
+    { 255,  59,   0,  59, 64,  0, 59 },
+    {  10, 200,  10,   0, 60, 10, 59 },
+    {   0,   0, 255, 255, 60, 59, 59 },
+    { 255, 255, 200, 200,  0,  0,  0 },
+};
+
+static uint16_t count_pixels()
+{
+    uint16_t count = 0;
+    for (uint8_t y = 0; y < CANVAS_HEIGHT; ++y)
+    {
+        for (uint8_t x = 0; x < CANVAS_WIDTH; ++x)
+        {
+            count += canvas_get(x, y);
+        }
+    }
+    return count;
+}
+
+bool canvas_check()
+{
+    bool ok = true;
+    for (const LineCase& line : lines)
+    {
+        canvas_init(Nametable::A);
+        canvas_line(line.x0, line.y0, line.x1, line.y1);
+
+        uint16_t count = count_pixels();
+        bool has_pixel = line.pixels == 0 || canvas_get(line.px, line.py);
+        if (count != line.pixels || !has_pixel)
+        {
+            printf("canvas_line(%u, %u, %u, %u): %u pixels, expected %u including %u,%u\n",
+                line.x0, line.y0, line.x1, line.y1, count, line.pixels, line.px, line.py);
+            ok = false;
+        }
+    }
+
+    puts(ok ? "canvas check passed" : "canvas check FAILED");
+
+    canvas_init(Nametable::A);
+    return ok;
+}
+
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+/**
+ * @brief Check for the canvas line clipping. Draws lines with endpoints on, past and far past the edges of the
+ *        canvas, and compares the pixels that got set with what a clipped line should leave behind. Mismatches are
+ *        printed to stdout (see printf-mesen2.lua).
+ *
+ *        Only in builds configured with -DCANVAS_CHECK=On. Call once at boot, it only touches the canvas bitmap
+ *        and leaves it cleared with nothing to flush.
+ *
+ * @return true if every line matched
+ */
+#if CANVAS_CHECK
+bool canvas_check();
+#else
+inline bool canvas_check() { return true; }
+#endif
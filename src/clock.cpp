@@ -0,0 +1,69 @@
+#include "clock.hpp"
+
+#include <cstdint>
+#include <neslib.h>
+
+// A tick is 5 fifths. An NTSC frame is worth exactly one tick, a PAL frame 6/5 of one.
+static constexpr uint8_t FIFTHS_PER_TICK = 5;
+static constexpr uint8_t fifths_per_frame[CLOCK_REGION_COUNT] = { 5, 6 };
+
+static_assert(fifths_per_frame[CLOCK_NTSC] * 60 == FIFTHS_PER_TICK * CLOCK_TICK_RATE, "NTSC is 60 frames a second");
+static_assert(fifths_per_frame[CLOCK_PAL] * 50 == FIFTHS_PER_TICK * CLOCK_TICK_RATE, "PAL is 50 frames a second");
+
+static Clock_Region region;
+static uint8_t frame_rate;
+static uint8_t last_frame;
+// Fifths of a tick that didn't add up to a whole one yet
+static uint8_t remainder;
+
+void clock_init()
+{
+    // neslib times a frame at boot, 0 is PAL. Dendy clones run at 50 Hz too but time close to NTSC,
+    // they'll play a bit slow.
+    region = ppu_system() ? CLOCK_NTSC : CLOCK_PAL;
+    frame_rate = fifths_per_frame[region];
+    clock_resync();
+}
+
+Clock_Region clock_region()
+{
+    return region;
+}
+
+void clock_resync()
+{
+    last_frame = nesclock();
+    remainder = 0;
+}
+
+uint8_t clock_steps()
+{
+    uint8_t now = nesclock();
+    uint8_t frames = now - last_frame;
+    last_frame = now;
+
+    // Never less than the frame we're about to run, even right after a resync.
+    if (frames == 0)
+    {
+        frames = 1;
+    }
+
+    uint8_t steps = 0;
+    while (frames != 0)
+    {
+        --frames;
+        remainder += frame_rate;
+        while (remainder >= FIFTHS_PER_TICK)
+        {
+            remainder -= FIFTHS_PER_TICK;
+            ++steps;
+        }
+
+        if (steps >= CLOCK_MAX_STEPS)
+        {
+            // Too far behind, drop the rest.
+            return CLOCK_MAX_STEPS;
+        }
+    }
+    return steps;
+}
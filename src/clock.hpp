@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Fixed timestep game clock, so the game plays at the same speed on NTSC (60 Hz) and PAL (50 Hz).
+ *
+ *        All of the game logic runs in ticks of 1/60 of a second, which is what every speed, timer and
+ *        animation length in the game was tuned at. On NTSC that's one tick a frame. On PAL the main loop
+ *        runs an extra tick every 5th frame (6 ticks per 5 frames), so bullets fly, enemies spawn and the
+ *        wave script ramps up at the same rate in real time.
+ *
+ *        The region only decides how many fifths of a tick a frame is worth, looked up from a table, so
+ *        there's no division or per-value scaling at runtime. Frames missed to lag are caught up the same way,
+ *        but never more than CLOCK_MAX_STEPS ticks in one frame: a long stall slows the game down for a
+ *        moment instead of making the next frames even slower trying to catch up.
+ *
+ *        Write durations with SECONDS() so they read in real time and are turned into ticks at compile time.
+ */
+
+/**
+ * @brief Logic ticks per second, on every region.
+ */
+constexpr uint8_t CLOCK_TICK_RATE = 60;
+
+/**
+ * @brief Most ticks a single frame will run. Anything past that is dropped.
+ */
+constexpr uint8_t CLOCK_MAX_STEPS = 2;
+
+enum Clock_Region : uint8_t
+{
+    CLOCK_NTSC,
+    CLOCK_PAL,
+    CLOCK_REGION_COUNT,
+};
+
+/**
+ * @brief Ticks for a duration in seconds, rounded to the nearest tick.
+ */
+consteval uint16_t SECONDS(float seconds)
+{
+    if (seconds < 0 || seconds * CLOCK_TICK_RATE > 65535)
+    {
+        throw "Duration out of range";
+    }
+    return (uint16_t)(seconds * CLOCK_TICK_RATE + 0.5f);
+}
+
+/**
+ * @brief Detect the region. Call once at boot, before turning the screen on.
+ */
+void clock_init();
+
+Clock_Region clock_region();
+
+/**
+ * @brief Start counting from the current frame, forgetting any frames that went by since the last call to
+ *        `clock_steps`. For deliberate waits (loading a state, the zapper check) that shouldn't be caught up.
+ */
+void clock_resync();
+
+/**
+ * @brief How many ticks to run this frame. Call once at the top of the frame, right after the NMI wait.
+ *
+ * @return between 1 and CLOCK_MAX_STEPS
+ */
+uint8_t clock_steps();
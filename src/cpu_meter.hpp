@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief On screen CPU meter. Built with -DCPU_METER=On, every phase of the frame sets the PPU's color emphasis
+ *        (or grayscale) bits when it starts, so the scanlines the PPU draws while that phase runs get tinted.
+ *        The band of color a subsystem leaves down the screen is how long it took, about 113 CPU cycles a line,
+ *        and whatever is left untinted at the bottom is the time to spare. Works on real hardware and in any
+ *        emulator, no debugger needed.
+ *
+ *        Only $2001 is written, never neslib's copy of the mask, so NMI puts the normal mask back every frame.
+ *        Without CPU_METER every call compiles to nothing.
+ *
+ *        Emphasis colors are for NTSC, on PAL red and green are swapped. Time spent before the NMI returns
+ *        (the VRAM uploads and audio) shows as untinted above the first band,
+ *        and the sprite zero wait as an untinted gap in the input band.
+ */
+
+/**
+ * @brief The bits OR'd into the mask for each phase: grayscale is bit 0, emphasis red, green and blue are bits 5-7.
+ */
+enum Cpu_Meter_Phase : uint8_t
+{
+    // Waiting for NMI, nothing left to do this frame
+    CPU_METER_IDLE = 0x00,
+    // Reading the pads and the zapper
+    CPU_METER_INPUT = 0x80,
+    // update_player
+    CPU_METER_PLAYER = 0x20,
+    // Camera, arena streaming and the wave script
+    CPU_METER_WORLD = 0x60,
+    // Updating (and drawing) every entity
+    CPU_METER_ENTITIES = 0x40,
+    // Clearing OAM and drawing the projectiles and particles
+    CPU_METER_OAM = 0xa0,
+    // The zapper hit test. Grayscale only, tinting would darken the white boxes the zapper looks for.
+    CPU_METER_ZAPPER = 0x01,
+};
+
+#if CPU_METER
+
+#include <peekpoke.h>
+
+// neslib's copy of the mask, written to $2001 every NMI
+extern "C" volatile __zeropage uint8_t PPU_MASK_VAR;
+
+/**
+ * @brief Start timing a phase, the previous one ends here.
+ */
+inline void cpu_meter(Cpu_Meter_Phase phase)
+{
+    POKE(0x2001, PPU_MASK_VAR | phase);
+}
+
+#else
+
+inline void cpu_meter(Cpu_Meter_Phase) {}
+
+#endif
@@ -0,0 +1,125 @@
+#include "enemy.hpp"
+#include "arena.hpp"
+
+#include <cstdint>
+
+// Speed (always positive) to leave the screen edge with after a bounce.
+static fs8_8 bounce_speed(fs8_8 vel, const EnemyBehavior& behavior)
+{
+    fs8_8 speed = MABS(vel);
+    if (behavior.halve_speed_on_bounce)
+    {
+        speed = speed / 2;
+    }
+    return speed;
+}
+
+void enemy_spawn(Entity& Object, Enemy_Kinds kind)
+{
+    const EnemyBehavior& behavior = enemy_behaviors[kind];
+
+    Object.kind = kind;
+    Object.vel_x = 0;
+    Object.vel_y = 0;
+    Object.steer_x = 0;
+    Object.steer_y = 0;
+    anim_play(Object, behavior.anim_clip);
+    enemy_retarget(Object);
+}
+
+void enemy_retarget(Entity& Object)
+{
+    const EnemyBehavior& behavior = enemy_behaviors[Object.kind];
+
+    if (behavior.movement != MOVE_HOMING)
+    {
+        return;
+    }
+
+    // Steer towards the player's feet. The player is 16x32 with a top left origin,
+    // so the bottom 16x16 area starts 16 pixels down.
+    if (p1.x.as_i() < Object.x.as_i())
+    {
+        Object.steer_x = -1;
+    }
+    else if (p1.x.as_i() > Object.x.as_i())
+    {
+        Object.steer_x = 1;
+    }
+    else
+    {
+        Object.steer_x = 0;
+    }
+
+    if ((p1.y.as_i() + 16) < Object.y.as_i())
+    {
+        Object.steer_y = -1;
+    }
+    else if ((p1.y.as_i() + 16) > Object.y.as_i())
+    {
+        Object.steer_y = 1;
+    }
+    else
+    {
+        Object.steer_y = 0;
+    }
+}
+
+void enemy_integrate(Entity& Object)
+{
+    const EnemyBehavior& behavior = enemy_behaviors[Object.kind];
+
+    if (Object.steer_x < 0)
+    {
+        if (Object.vel_x > -behavior.max_speed)
+        {
+            Object.vel_x -= behavior.acceleration;
+        }
+    }
+    else if (Object.steer_x > 0)
+    {
+        if (Object.vel_x < behavior.max_speed)
+        {
+            Object.vel_x += behavior.acceleration;
+        }
+    }
+
+    if (Object.steer_y < 0)
+    {
+        if (Object.vel_y > -behavior.max_speed)
+        {
+            Object.vel_y -= behavior.acceleration;
+        }
+    }
+    else if (Object.steer_y > 0)
+    {
+        if (Object.vel_y < behavior.max_speed)
+        {
+            Object.vel_y += behavior.acceleration;
+        }
+    }
+
+    constexpr uint8_t SCREEN_BORDER = 8;
+    // If approaching border of the arena, reverse direction.
+    // Also cut the velocity in half if this enemy type wants that.
+    if (Object.vel_x < 0 && Object.x.as_i() < SCREEN_BORDER)
+    {
+        Object.vel_x = bounce_speed(Object.vel_x, behavior);
+    }
+    else if (Object.vel_x > 0 && Object.x.as_i() + 16 > (ARENA_WIDTH - SCREEN_BORDER))
+    {
+        Object.vel_x = -bounce_speed(Object.vel_x, behavior);
+    }
+    // Also for the y axis which is 240 pixels high.
+    if (Object.vel_y < 0 && Object.y.as_i() < SCREEN_BORDER)
+    {
+        Object.vel_y = bounce_speed(Object.vel_y, behavior);
+    }
+    else if (Object.vel_y > 0 && Object.y.as_i() + 16 > (240 - SCREEN_BORDER))
+    {
+        Object.vel_y = -bounce_speed(Object.vel_y, behavior);
+    }
+
+    Object.x += Object.vel_x;
+    Object.y += Object.vel_y;
+}
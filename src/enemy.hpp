@@ -0,0 +1,81 @@
+#pragma once
+
+#include "main.hpp"
+#include "anim.hpp"
+
+#include <cstdint>
+#include <fixed_point.h>
+
+/**
+ * @brief How an enemy type decides where to go.
+ *        HOMING - steers towards the player whenever it re-targets.
+ */
+enum Enemy_Movement : uint8_t
+{
+    MOVE_HOMING = 0,
+};
+
+enum Enemy_Kinds : uint8_t
+{
+    ENEMY_KIND_BOT = 0,
+    ENEMY_KIND_COUNT,
+};
+
+/**
+ * @brief Everything that makes one enemy type different from another. One entry per `Enemy_Kinds`
+ *        lives in `enemy_behaviors`, so adding a new enemy is a table edit rather than a new update function.
+ */
+struct EnemyBehavior
+{
+    Enemy_Movement movement;
+
+    fs8_8 max_speed;
+    fs8_8 acceleration;
+
+    // Lose half the speed when bouncing off the edge of the screen.
+    bool halve_speed_on_bounce;
+
+    Anim_Clips anim_clip;
+
+    // The player touches the enemy (and dies) when their feet are within this many pixels of the enemy's
+    // origin on both axes.
+    uint8_t hitbox_size;
+};
+
+constexpr EnemyBehavior enemy_behaviors[ENEMY_KIND_COUNT] =
+{
+    // ENEMY_KIND_BOT
+    {
+        .movement = MOVE_HOMING,
+        .max_speed = 5.0_s8_8,
+        .acceleration = 0.01_s8_8,
+        .halve_speed_on_bounce = true,
+        .anim_clip = ANIM_BOT_WALK,
+        .hitbox_size = 8,
+    },
+};
+
+/**
+ * @brief AI decisions are spread across this many frames. Each frame only the entity slots where
+ *        `(slot & (AI_SLICES - 1)) == ai_phase` re-target, so at most NUM_ENTITIES / AI_SLICES enemies
+ *        run their decision logic in any given frame. Must be a power of 2.
+ */
+constexpr uint8_t AI_SLICES = 4;
+static_assert((AI_SLICES & (AI_SLICES - 1)) == 0, "AI_SLICES must be a power of 2");
+
+/**
+ * @brief Reset the movement state of a freshly spawned enemy and give it its first AI decision.
+ */
+void enemy_spawn(Entity& Object, Enemy_Kinds kind);
+
+/**
+ * @brief Run the (comparatively expensive) decision logic for an enemy. Only call this on the frame
+ *        that belongs to the enemy's AI slice.
+ */
+void enemy_retarget(Entity& Object);
+
+/**
+ * @brief Cheap per-frame movement. Applies the last AI decision to the velocity, bounces off
+ *        the screen edges and moves the enemy. Must run every frame for every enemy.
+ */
+void enemy_integrate(Entity& Object);
@@ -0,0 +1,72 @@
+#include "event_log.hpp"
+
+#if EVENT_LOG
+
+#include <cstdint>
+#include <peekpoke.h>
+
+static_assert((EVENT_LOG_SIZE & (EVENT_LOG_SIZE - 1)) == 0, "EVENT_LOG_SIZE must be a power of 2");
+
+// Read by event-log-mesen2.lua. $401A is unmapped on the NES, so these writes are harmless.
+constexpr uint16_t EVENT_LOG_PORT = 0x401A;
+
+// One array per field, so every field is a single indexed store.
+static uint8_t ids[EVENT_LOG_SIZE];
+static uint8_t arg0[EVENT_LOG_SIZE];
+static uint8_t arg1[EVENT_LOG_SIZE];
+static uint8_t arg2[EVENT_LOG_SIZE];
+// Both only ever count up, the slot is the low bits.
+static uint8_t head;
+static uint8_t tail;
+static uint8_t dropped;
+
+void event_log(Event_Ids id, uint8_t a, uint8_t b, uint8_t c)
+{
+    if ((uint8_t)(head - tail) == EVENT_LOG_SIZE)
+    {
+        if (dropped != 0xff)
+        {
+            ++dropped;
+        }
+        return;
+    }
+    uint8_t slot = head & (EVENT_LOG_SIZE - 1);
+    ids[slot] = id;
+    arg0[slot] = a;
+    arg1[slot] = b;
+    arg2[slot] = c;
+    ++head;
+}
+
+static void write_event(uint8_t id, uint8_t a, uint8_t b, uint8_t c)
+{
+    POKE(EVENT_LOG_PORT, id);
+    POKE(EVENT_LOG_PORT, a);
+    POKE(EVENT_LOG_PORT, b);
+    POKE(EVENT_LOG_PORT, c);
+}
+
+void event_log_flush()
+{
+    uint8_t count = head - tail;
+    if (count == 0 && dropped == 0)
+    {
+        return;
+    }
+
+    // The number of events first, so the script knows where each one starts.
+    POKE(EVENT_LOG_PORT, count + (dropped != 0 ? 1 : 0));
+    if (dropped != 0)
+    {
+        write_event(EVENT_LOG_DROPPED, dropped, 0, 0);
+        dropped = 0;
+    }
+    while (tail != head)
+    {
+        uint8_t slot = tail & (EVENT_LOG_SIZE - 1);
+        write_event(ids[slot], arg0[slot], arg1[slot], arg2[slot]);
+        ++tail;
+    }
+}
+
+#endif
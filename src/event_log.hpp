@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Binary event log for profiling builds (EVENT_LOG, set from CMakeLists.txt).
+ *
+ *        An event is 4 bytes: its id from events.inc and 3 byte arguments. `event_log` only puts it in a ring buffer
+ *        in RAM, and `event_log_flush` writes out everything logged during the frame to $401A in one go. Nothing is
+ *        formatted on the NES, the build generates event-log-mesen2.lua from events.inc, which turns the events back
+ *        into text in Mesen 2's log window. A log call is a few dozen cycles and pulls in none of printf, so logging
+ *        can be left on while profiling.
+ *
+ *        If more than EVENT_LOG_SIZE events are logged in a frame, the newest ones are dropped and the next flush
+ *        starts with a LOG_DROPPED event saying how many.
+ */
+
+enum Event_Ids : uint8_t
+{
+#define EVENT(name, format) EVENT_##name,
+#include "events.inc"
+#undef EVENT
+    EVENT_COUNT,
+};
+
+/**
+ * @brief Events the buffer holds between flushes. Must be a power of 2.
+ */
+constexpr uint8_t EVENT_LOG_SIZE = 16;
+
+#if EVENT_LOG
+
+void event_log(Event_Ids id, uint8_t a = 0, uint8_t b = 0, uint8_t c = 0);
+
+/**
+ * @brief Write the logged events out to the debug port. Call once a frame.
+ */
+void event_log_flush();
+
+#else
+
+inline void event_log(Event_Ids, uint8_t = 0, uint8_t = 0, uint8_t = 0) {}
+inline void event_log_flush() {}
+
+#endif
@@ -0,0 +1,164 @@
+#include "kernel_check.hpp"
+
+#if KERNEL_CHECK
+
+#include <cstdint>
+#include <cstdio>
+#include <neslib.h>
+#include <nesdoug.h>
+
+#include "metasprite.hpp"
+#include "metatile.hpp"
+
+// Include the VRAM buffer and the VRAM_INDEX so we can compare what the kernels wrote.
+extern volatile uint8_t VRAM_BUF[128];
+extern volatile __zeropage uint8_t VRAM_INDEX;
+
+static volatile uint8_t* const OAM_BUF = (volatile uint8_t*)0x0200;
+
+// Anything the kernels don't write keeps this, so writing too much shows up too.
+constexpr uint8_t FILL = 0xaa;
+
+// Covers every nametable, both ends of a row and rows on both sides of an attribute boundary.
+static constexpr uint8_t nametables[] = { 0x00, 0x04, 0x08, 0x0c };
+static constexpr uint8_t columns[] = { 0, 13, 30 };
+static constexpr uint8_t rows[] = { 0, 7, 8, 27 };
+
+static constexpr Metatile_2_2 test_tile_2_2 = { 0x1e, 0xf0 };
+static constexpr Metatile_2_3 test_tile_2_3 = { 0x1e, 0xf0, 0x5a };
+
+// Positive and negative offsets, and one that ends exactly at the end of OAM.
+static constexpr int8_t test_sprite[] =
+{
+      0,  0, 0x0f, 0,
+     12,  5, 0x05, 3,
+    - 4, 24, 0x08, 0x42,
+    (int8_t)0x80,
+};
+static constexpr uint8_t sprite_positions[] = { 0, 120, 250 };
+static constexpr uint8_t oam_offsets[] = { 0, 100, 244 };
+
+static uint8_t expected[256];
+
+// The helpers below are only used by the kernels that were built as asm.
+
+[[maybe_unused]]
+static void fill_vram_buf()
+{
+    for (uint8_t i = 0; i < sizeof(VRAM_BUF); ++i)
+    {
+        VRAM_BUF[i] = FILL;
+    }
+    VRAM_INDEX = 0;
+}
+
+[[maybe_unused]]
+static void fill_oam()
+{
+    for (uint16_t i = 0; i < 256; ++i)
+    {
+        OAM_BUF[i] = FILL;
+    }
+}
+
+// Compare the first `len` bytes of `buf` with `expected`, and print the kernel name and inputs on a mismatch.
+[[maybe_unused]]
+static bool matches(volatile uint8_t* buf, uint16_t len, const char* kernel, uint8_t a, uint8_t b, uint8_t c)
+{
+    for (uint16_t i = 0; i < len; ++i)
+    {
+        if (buf[i] != expected[i])
+        {
+            printf("%s(%u, %u, %u): byte %u is %02x, expected %02x\n", kernel, a, b, c, i, buf[i], expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+#if METATILE_ASM
+template<typename Tile>
+using MetatileKernel = void (*)(Nametable, uint8_t, uint8_t, const Tile*);
+
+template<typename Tile>
+static bool check_metatile(MetatileKernel<Tile> kernel, MetatileKernel<Tile> reference, const Tile& tile, const char* name)
+{
+    bool ok = true;
+    for (uint8_t nmt : nametables)
+    {
+        for (uint8_t x : columns)
+        {
+            for (uint8_t y : rows)
+            {
+                fill_vram_buf();
+                reference((Nametable)nmt, x, y, &tile);
+                for (uint8_t i = 0; i < sizeof(VRAM_BUF); ++i)
+                {
+                    expected[i] = VRAM_BUF[i];
+                }
+                uint8_t expected_index = VRAM_INDEX;
+
+                fill_vram_buf();
+                kernel((Nametable)nmt, x, y, &tile);
+                ok &= matches(VRAM_BUF, sizeof(VRAM_BUF), name, nmt, x, y);
+                if (VRAM_INDEX != expected_index)
+                {
+                    printf("%s(%u, %u, %u): VRAM_INDEX is %u, expected %u\n", name, nmt, x, y, VRAM_INDEX, expected_index);
+                    ok = false;
+                }
+            }
+        }
+    }
+    return ok;
+}
+#endif
+
+#if METASPRITE_ASM
+static bool check_metasprite()
+{
+    bool ok = true;
+    for (uint8_t pos : sprite_positions)
+    {
+        for (uint8_t offset : oam_offsets)
+        {
+            fill_oam();
+            uint8_t expected_offset = draw_metasprite_cpp(pos, pos, test_sprite, offset);
+            for (uint16_t i = 0; i < 256; ++i)
+            {
+                expected[i] = OAM_BUF[i];
+            }
+
+            fill_oam();
+            uint8_t result_offset = draw_metasprite(pos, pos, test_sprite, offset);
+            ok &= matches(OAM_BUF, 256, "draw_metasprite", pos, pos, offset);
+            if (result_offset != expected_offset)
+            {
+                printf("draw_metasprite(%u, %u, %u): returned %u, expected %u\n", pos, pos, offset, result_offset, expected_offset);
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+#endif
+
+bool kernel_check()
+{
+    bool ok = true;
+
+#if METATILE_ASM
+    ok &= check_metatile(draw_metatile_2_2, draw_metatile_2_2_cpp, test_tile_2_2, "draw_metatile_2_2");
+    ok &= check_metatile(draw_metatile_2_3, draw_metatile_2_3_cpp, test_tile_2_3, "draw_metatile_2_3");
+#endif
+#if METASPRITE_ASM
+    ok &= check_metasprite();
+#endif
+
+    puts(ok ? "kernel check passed" : "kernel check FAILED");
+
+    clear_vram_buffer();
+    oam_clear();
+    return ok;
+}
+
+#endif
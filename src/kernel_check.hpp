@@ -0,0 +1,17 @@
+#pragma once
+
+/**
+ * @brief Equivalence check for the asm kernels in ca65/kernels.s. Runs every kernel that was built as asm and its
+ *        C++ reference on the same inputs and compares the VRAM_BUF / OAM bytes they write. Mismatches are printed
+ *        to stdout (see printf-mesen2.lua).
+ *
+ *        Only in builds configured with -DKERNEL_CHECK=On. Call once at boot with rendering off, it leaves
+ *        VRAM_BUF and OAM cleared.
+ *
+ * @return true if every kernel matched its reference
+ */
+#if KERNEL_CHECK
+bool kernel_check();
+#else
+inline bool kernel_check() { return true; }
+#endif
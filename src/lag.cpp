@@ -0,0 +1,55 @@
+#include "lag.hpp"
+
+#include <cstdint>
+#include <neslib.h>
+#include <peekpoke.h>
+
+static uint8_t frame_start;
+static uint8_t pressure;
+static bool ignore_frame;
+static bool shedding;
+// Flips every frame, shedding only happens when it's set.
+static bool shed_phase;
+
+void lag_frame_begin()
+{
+    frame_start = nesclock();
+    ignore_frame = false;
+
+    shed_phase = !shed_phase;
+    shedding = shed_phase && pressure > LAG_SHED_THRESHOLD;
+}
+
+bool lag_frame_end()
+{
+    bool overrun = !ignore_frame && (uint8_t)nesclock() != frame_start;
+
+    if (overrun)
+    {
+        pressure = (pressure > LAG_PRESSURE_MAX - LAG_PRESSURE_PER_FRAME)
+            ? LAG_PRESSURE_MAX
+            : pressure + LAG_PRESSURE_PER_FRAME;
+    }
+    else if (pressure != 0)
+    {
+        --pressure;
+    }
+
+#if LAG_PROFILE
+    // Marker for lag-frames-mesen2.lua. $401E is unmapped on the NES, so this write is harmless.
+    // Bit 0 is set on a lag frame, bit 1 when this frame shed work.
+    POKE(0x401E, (overrun ? 1 : 0) | (shedding ? 2 : 0));
+#endif
+
+    return overrun;
+}
+
+void lag_ignore_frame()
+{
+    ignore_frame = true;
+}
+
+bool lag_shed()
+{
+    return shedding;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Lag frame detection and load shedding.
+ *
+ *        neslib counts NMIs in `nesclock()`. If the count changed between `lag_frame_begin` and `lag_frame_end`,
+ *        NMI fired while the frame was still being worked on, so `ppu_wait_nmi` will wait for the one after it
+ *        and the game drops to 30 fps for that frame.
+ *
+ *        One lag frame now and then (a burst of spawns, a full screen of sprites) isn't worth reacting to, so
+ *        lag frames add to a pressure counter that drains by one every frame that fits. Once the pressure is
+ *        over LAG_SHED_THRESHOLD, `lag_shed` turns true on every other frame and the callers skip their
+ *        non-essential work on those frames: animation ticks, particles and AI re-targeting. Nothing that
+ *        changes what the player can hit or get hit by is ever skipped.
+ *
+ *        Run Mesen with `lag-frames-mesen2.lua` on a build configured with -DLAG_PROFILE=On to watch the
+ *        lag and shed counts as the game runs. The script does the counting, the ROM only marks each frame.
+ */
+
+/**
+ * @brief Pressure added by a lag frame. Every frame that fits takes one off again.
+ */
+constexpr uint8_t LAG_PRESSURE_PER_FRAME = 16;
+
+/**
+ * @brief Shedding starts when the pressure gets over this. With the values here that's 2 lag frames
+ *        less than 8 frames apart.
+ */
+constexpr uint8_t LAG_SHED_THRESHOLD = 24;
+
+/**
+ * @brief Cap on the pressure, so shedding stops about half a second after the lag does
+ *        even if the game was lagging for a long time.
+ */
+constexpr uint8_t LAG_PRESSURE_MAX = 56;
+
+/**
+ * @brief Call at the top of the frame, right after the NMI wait.
+ */
+void lag_frame_begin();
+
+/**
+ * @brief Call once the frame's work is done, right before the NMI wait.
+ *
+ * @return true if this frame ran over into the next one
+ */
+bool lag_frame_end();
+
+/**
+ * @brief Don't count the current frame. For frames that wait for NMI on purpose (the zapper check),
+ *        which would otherwise look like lag.
+ */
+void lag_ignore_frame();
+
+/**
+ * @brief Should non-essential work be skipped this frame? Stays the same for the whole frame.
+ */
+bool lag_shed();
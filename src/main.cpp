@@ -16,8 +16,31 @@
 #include <zaplib.h>
 
 // Include our own player update function for the movable sprite.
+#include "anim.hpp"
+#include "arena.hpp"
+#include "audio.hpp"
+#include "big_digits.hpp"
+#include "canvas_check.hpp"
+#include "clock.hpp"
+#include "cpu_meter.hpp"
+#include "event_log.hpp"
+#include "enemy.hpp"
+#include "lag.hpp"
+#include "kernel_check.hpp"
+#include "metasprite.hpp"
 #include "metatile.hpp"
+#include "palette_fx.hpp"
+#include "particles.hpp"
+#include "popup.hpp"
+#include "projectile.hpp"
+#include "screen.hpp"
+#include "screen_bake.hpp"
+#include "split.hpp"
+#include "task.hpp"
+#include "text_pool.hpp"
 #include "text_render.hpp"
+#include "vram_fast.hpp"
+#include "waves.hpp"
 #include "metasprites.h"
 
 // define this somewhere in main.c this will write a string one byte a time to $401b
@@ -28,22 +51,68 @@ const unsigned char nametable[] = {
     #embed "../default-nametable-rle.nam"
 };
 
-const unsigned char screen_title[] = {
-    #embed "../screen_title.nrle"
+// The screens are converted from the screen_*.nss sessions at build time, see cmake/add-nss-assets.cmake.
+constexpr unsigned char screen_title[] = {
+    #include "screen_title.nrle.inc"
 };
 
-const unsigned char screen_gameplay[] = {
-    #embed "../screen_gameplay.nrle"
+constexpr unsigned char screen_gameplay[] = {
+    #include "screen_gameplay.nrle.inc"
 };
 
-const unsigned char screen_gameover[] = {
-    #embed "../screen_gameover.nrle"
+constexpr unsigned char screen_gameover[] = {
+    #include "screen_gameover.nrle.inc"
 };
 
+// The text and tiles each state always starts with are drawn into its screen at compile time (see screen_bake.hpp),
+// so entering the state doesn't have to draw them. Only what changes is drawn at runtime.
+
+// The ammo display at the bottom of the screen, one bullet icon per round filled in from the right.
+constexpr uint8_t AMMO_ICON_TILE = 0x05;
+constexpr uint8_t AMMO_BOTTOM_X = 29;
+constexpr uint8_t AMMO_BOTTOM_Y = 27;
+
+// The starting ammo
+#define AMMO_ICON_STAMPS \
+    screen_tile_run(AMMO_BOTTOM_X + 1 - START_AMMO, AMMO_BOTTOM_Y, AMMO_ICON_TILE, START_AMMO)
+
+constexpr ScreenStamp tutorial_stamps[] = {
+    screen_text(2, 4,  " MOVE with DPAD"),
+    screen_text(2, 12, " SHOOT with the"),
+    screen_text(2, 16, "        ZAPPER"),
+    screen_text(18, 26, "AMMO"),
+    AMMO_ICON_STAMPS,
+};
+constexpr auto screen_tutorial = bake_screen<screen_gameplay, tutorial_stamps>();
+
+constexpr ScreenStamp gameplay_stamps[] = {
+#if !BIG_SCORE
+    screen_text(2, 2, "000"),
+#endif
+    AMMO_ICON_STAMPS,
+};
+constexpr auto screen_gameplay_hud = bake_screen<screen_gameplay, gameplay_stamps>();
+
+constexpr ScreenStamp gameover_stamps[] = {
+    screen_text(8, 196/8, "Score"),
+};
+constexpr auto screen_gameover_hud = bake_screen<screen_gameover, gameover_stamps>();
+
 // On the Game Genie, only color 0 and 3 of each palette will be used
 
 const unsigned char palette_metaspr_a[16]={ 0x0f,0x00,0x10,0x30,0x0f,0x0c,0x21,0x32,0x0f,0x05,0x16,0x27,0x0f,0x0b,0x1a,0x29 };
 
+// Colors the high score flashes through on the game over screen.
+const uint8_t highscore_colors[] = { 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b };
+
+constexpr PaletteCycle highscore_cycle =
+{
+    .pal_index = 3,
+    .frames_per_step = 4,
+    .length = sizeof(highscore_colors),
+    .colors = highscore_colors,
+};
+
 struct SpawnArea
 {
     uint8_t start_x;
@@ -99,12 +168,12 @@ SpawnArea spawn_area_collections[2][2][3] =
 };
 
 // Tracking Zapper State
-static uint8_t zapper_pressed = 0;
-static uint8_t zapper_ready = 0; //wait till it's 0
+static ZP_HOT uint8_t zapper_pressed = 0;
+static ZP_HOT uint8_t zapper_ready = 0; //wait till it's 0
 
 // Tracking gamepad state (held and pressed)
-static uint8_t pad = 0;
-static uint8_t pad_pressed = 0;
+static ZP_HOT uint8_t pad = 0;
+static ZP_HOT uint8_t pad_pressed = 0;
 
 // We defined this data in ca65 as an example of how to reference labels defined in asm in C
 extern const uint8_t example_ca65_data[];
@@ -116,26 +185,84 @@ extern uint8_t __zeropage var_defined_in_ca65;
 Entity ActiveEntities[NUM_ENTITIES];
 
 // Player object.
-Entity p1;
+ZP_HOT Entity p1;
 
 Game_States cur_state = Game_States::STATE_TITLE;
 
 // Frame tick counter since power-on (incremented once per main loop iteration)
-static uint16_t ticks16 = 0; // 32-bit to avoid quick wrap; NES time constraints minimal
+static ZP_HOT uint16_t ticks16 = 0; // 32-bit to avoid quick wrap; NES time constraints minimal
 
 static uint16_t score = 0;
 static uint16_t hiscore = 0;
 static bool is_highscore = false;
+#if BIG_SCORE
+// The score in the top left of the HUD, in big digits
+static BigNumber score_display;
+#endif
+
+static uint8_t ammo_count = START_AMMO;
+// How many ammo icons are on screen. Catches up with ammo_count in ammo_display_update().
+static uint8_t ammo_shown = START_AMMO;
+
+// The ammo icons, one per bullet, filled in from the right.
+#if ARENA_SCROLL
+// Everything below the top HUD scrolls with the arena, so the icons go in the top HUD between the score and
+// the high score.
+constexpr uint8_t AMMO_ICON_X = 23;
+constexpr uint8_t AMMO_ICON_Y = 3;
+#else
+constexpr uint8_t AMMO_ICON_X = AMMO_BOTTOM_X;
+constexpr uint8_t AMMO_ICON_Y = AMMO_BOTTOM_Y;
+#endif
+static_assert(AMMO_ICON_X + 1 >= MAX_AMMO, "MAX_AMMO icons don't fit left of AMMO_ICON_X");
+
+// PPU address of the icon for bullet `index`, counting from 0.
+static uint16_t ammo_icon_addr(uint8_t index)
+{
+    return get_ppu_addr(screen_index(), (AMMO_ICON_X - index) * 8, AMMO_ICON_Y * 8);
+}
+
+// Add or clear icons until the display matches ammo_count. The VRAM buffer can be full when the ammo changes
+// (a long string being drawn can take most of it), so an icon that doesn't fit is tried again next time.
+static void ammo_display_update()
+{
+    while (ammo_shown != ammo_count)
+    {
+        if (ammo_shown < ammo_count)
+        {
+            if (!vram_tile(AMMO_ICON_TILE, ammo_icon_addr(ammo_shown)))
+            {
+                return;
+            }
+            ++ammo_shown;
+        }
+        else
+        {
+            if (!vram_tile(0x00, ammo_icon_addr(ammo_shown - 1)))
+            {
+                return;
+            }
+            --ammo_shown;
+        }
+    }
+}
 
-static uint8_t ammo_count = 3;
+static uint16_t ticks_in_state = 0;
 
-#define ENEMY_SPAWN_TIME 120
-static uint8_t enemy_spawn_timer = 0;
+// State requested by request_state(). The switch happens at the end of the frame.
+static Game_States next_state = Game_States::STATE_TITLE;
+static bool state_change_pending = false;
 
-#define AMMO_SPAWN_TIME (60 * 10)
-static uint16_t ammo_spawn_timer = 0;
+void request_state(Game_States new_state)
+{
+    next_state = new_state;
+    state_change_pending = true;
+}
 
-static uint16_t ticks_in_state = 0;
+bool is_state_change_pending()
+{
+    return state_change_pending;
+}
 
 void update_player();
 
@@ -170,13 +297,12 @@ void try_spawn_ammo_pickup(bool ignore_active_count = false, uint8_t x_override
 
         ActiveEntities[unused_index].vel_x = 0;
         ActiveEntities[unused_index].vel_y = 0;
-        ActiveEntities[unused_index].anim_counter = 0;
-        ActiveEntities[unused_index].anim_frame = 0;        
+        anim_play(ActiveEntities[unused_index], ANIM_NONE);
 
         if (x_override != 0xff && y_override != 0xff)
         {
-            // Spawn at the provided location.
-            ActiveEntities[unused_index].x = x_override;
+            // Spawn at the provided location (screen coordinates).
+            ActiveEntities[unused_index].x = camera_x + x_override;
             ActiveEntities[unused_index].y = y_override;
         }
         else
@@ -187,7 +313,7 @@ void try_spawn_ammo_pickup(bool ignore_active_count = false, uint8_t x_override
             // 3 quadrants randomly.
 
             // which of the 4 regions is the player in?
-            uint8_t x_region = (p1.x.as_i() / 128);
+            uint8_t x_region = ((p1.x.as_i() - camera_x) / 128);
             uint8_t y_region = (p1.y.as_i() / 120);
 
             // pick a region from the area that exludes the one the player is
@@ -196,13 +322,13 @@ void try_spawn_ammo_pickup(bool ignore_active_count = false, uint8_t x_override
 
             SpawnArea spawn_area = spawn_area_collections[x_region][y_region][area_choice];
 
-            ActiveEntities[unused_index].x = spawn_area.start_x + ((uint8_t)rand() % (128 - 16));
+            ActiveEntities[unused_index].x = camera_x + spawn_area.start_x + ((uint8_t)rand() % (128 - 16));
             ActiveEntities[unused_index].y = spawn_area.start_y + ((uint8_t)rand() % (120 - 16));                
         }
     }
 }
 
-void try_spawn_enemy()
+void try_spawn_enemy(uint8_t kind, Wave_Regions region)
 {
     // First, count how many active enemies there are and store a valid index
     // for an unused slot.
@@ -224,196 +350,201 @@ void try_spawn_enemy()
         }
     }
 
-    // If we have an unused slot, and we have less than 4 active enemies,
-    if (unused_index < NUM_ENTITIES && active_count < 4)
+    // If we have an unused slot, and we're below the wave script's enemy limit,
+    if (unused_index < NUM_ENTITIES && active_count < waves_max_enemies())
     {
         ActiveEntities[unused_index].cur_state = Entity_States::ACTIVE;
         ActiveEntities[unused_index].type = ENTITY_TYPE_ENEMY;
 
         // which of the 4 regions is the player in?
-        uint8_t x_region = (p1.x.as_i() / 128);
+        uint8_t x_region = ((p1.x.as_i() - camera_x) / 128);
         uint8_t y_region = (p1.y.as_i() / 120);
 
-        // pick a region from the area that exludes the one the player is
-        // in.
-        uint8_t area_choice = (uint8_t)(rand()) % 3;
+        SpawnArea spawn_area;
+        if (region == WAVE_REGION_OPPOSITE)
+        {
+            // spawn_points are in reading order, so flipping both halves gives the opposite corner.
+            spawn_area = spawn_points[(x_region ^ 1) + 2 * (y_region ^ 1)];
+        }
+        else
+        {
+            // pick a region from the area that exludes the one the player is
+            // in.
+            uint8_t area_choice = (uint8_t)(rand()) % 3;
 
-        SpawnArea spawn_area = spawn_area_collections[x_region][y_region][area_choice];
+            spawn_area = spawn_area_collections[x_region][y_region][area_choice];
+        }
 
-        ActiveEntities[unused_index].x = spawn_area.start_x + ((uint8_t)rand() % (128 - 16));
+        ActiveEntities[unused_index].x = camera_x + spawn_area.start_x + ((uint8_t)rand() % (128 - 16));
         ActiveEntities[unused_index].y = spawn_area.start_y + ((uint8_t)rand() % (120 - 16));                
 
-        ActiveEntities[unused_index].vel_x = 0;
-        ActiveEntities[unused_index].vel_y = 0;
-        ActiveEntities[unused_index].anim_counter = 0;
-        ActiveEntities[unused_index].anim_frame = 0;
+        enemy_spawn(ActiveEntities[unused_index], (Enemy_Kinds)kind);
     }
 }
 
-void goto_state(Game_States new_state)
+// Does nothing. Used in the state table for states that don't need an enter or exit step,
+// so dispatch never has to check for a missing function.
+static void state_noop()
 {
-    ticks_in_state = 0;
-
-    cur_state = new_state;
-
-    switch (cur_state) 
-    {
-        case Game_States::STATE_TITLE:
-        {
-            ppu_off();
-            oam_clear();
-            // Upload a basic palette we can use later.
-            pal_bg(palette_metaspr_a);
-            pal_spr(palette_metaspr_a);
-
-            // Set the scroll position on the screen to 0, 0
-            scroll(0, 0);
-
-            vram_adr(NAMETABLE_A);
-            vram_unrle(screen_title);   
-            ppu_on_all();         
-
-            // Metatile_2_2 test_tile;
-            // test_tile.top = 0x1f;
-            // test_tile.bot = 0x1f;
-
-            // draw_metatile_2_2(Nametable::A, 13, 20, &test_tile); // Flashing "Press Start"
-            break;
-        }
+}
 
-        case Game_States::STATE_TUTORIAL:
-        {
-            ppu_off();
-            vram_adr(NAMETABLE_A);
-            vram_unrle(screen_gameplay);        
+static void enter_state_title()
+{
+    oam_clear();
+    // Upload a basic palette we can use later.
+    pal_bg(palette_metaspr_a);
+    pal_spr(palette_metaspr_a);
 
-                                                                //0000000000000000
-            render_string(Nametable::A, 2, 4,  " MOVE with DPAD"_l);
-            render_string(Nametable::A, 2, 12, " SHOOT with the"_l);
-            render_string(Nametable::A, 2, 16, "        ZAPPER"_l);
+    screen_show(screen_title);
+    ppu_on_all();         
 
-            render_string(Nametable::A, 18, 26, "AMMO"_l);
+    audio_play_song(SONG_TITLE);
 
-            // allow vram to flush
-            ppu_wait_nmi();
+    // Metatile_2_2 test_tile;
+    // test_tile.top = 0x1f;
+    // test_tile.bot = 0x1f;
 
-            p1.cur_state = Entity_States::ACTIVE;
-            p1.x = 128 - 8;
-            p1.y = 180 - 16;
-            p1.vel_x = 0;
-            p1.vel_y = 0;
-            p1.anim_counter = 0;
-            p1.anim_frame = 0;          
+    // draw_metatile_2_2(Nametable::A, 13, 20, &test_tile); // Flashing "Press Start"
+}
 
-            ammo_count = 3;
-            
-            for (uint8_t i = 0; i < ammo_count; ++i)
-            {
-                vram_adr(NTADR_A(29 - i, 27));
-                vram_put(0x05); // bullet icon
-            }            
-            
-            ppu_on_all();         
+static void enter_state_tutorial()
+{
+    // The instructions and the ammo are part of the screen
+    screen_show(screen_tutorial.rle);
 
-            break;            
-        }
+    p1.cur_state = Entity_States::ACTIVE;
+    p1.x = 128 - 8;
+    p1.y = 180 - 16;
+    p1.vel_x = 0;
+    p1.vel_y = 0;
+    anim_play(p1, ANIM_PLAYER_IDLE);
 
-        case Game_States::STATE_GAMEPLAY:
-        {
-            // Reseed RNG every time we enter gameplay, using frame ticks as timing entropy.
-            srand((unsigned)ticks16);
-            ppu_off();
-            vram_adr(NAMETABLE_A);
-            vram_unrle(screen_gameplay);
+    ammo_count = START_AMMO;
+    
+    ppu_on_all();
+}
 
-            is_highscore = false;
-            score = 0;
-            render_string(Nametable::A, 2, 2, "000"_l);
+static void enter_state_gameplay()
+{
+    // Reseed RNG every time we enter gameplay, using frame ticks as timing entropy.
+    srand((unsigned)ticks16);
+#if ARENA_SCROLL
+    ppu_off();
+    arena_init();
+#else
+    // The starting ammo (and the score without BIG_SCORE) are part of the screen
+    screen_show(screen_gameplay_hud.rle);
+#endif
+
+    is_highscore = false;
+    score = 0;
+#if BIG_SCORE
+    big_number_init(score_display, screen_nmt(), 2, 1, 3);
+    big_number_update(score_display, score);
+#elif ARENA_SCROLL
+    render_string(screen_nmt(), 2, 2, "000"_l);
+#endif
+
+    if (hiscore != 0)
+    {
+        Letter score_digits[4] = { 
+            (Letter)4,
+            (Letter)((hiscore / 100) % 10), 
+            (Letter)((hiscore / 10) % 10), 
+            (Letter)(hiscore % 10) 
+        };
+
+        render_letters(screen_nmt(), 24, 2, score_digits);                
+    }
+    else
+    {
+        render_string(screen_nmt(), 24, 2, "000"_l);
+    }
 
-            if (hiscore != 0)
-            {
-                Letter score_digits[4] = { 
-                    (Letter)4,
-                    (Letter)((hiscore / 100) % 10), 
-                    (Letter)((hiscore / 10) % 10), 
-                    (Letter)(hiscore % 10) 
-                };
-
-                render_string(Nametable::A, 24, 2, score_digits);                
-            }
-            else
-            {
-                render_string(Nametable::A, 24, 2, "000"_l);
-            }
+    // Clear out all entities
+    for (unsigned char i = 0; i < NUM_ENTITIES; ++i)
+    {
+        ActiveEntities[i].cur_state = Entity_States::UNUSED;
+    }
+    projectiles_clear();
+    particles_clear();
+    popups_clear();
+
+    // Reset player position and state
+    p1.cur_state = Entity_States::ACTIVE;
+    p1.x = 128 - 8;
+    p1.y = 120 - 16;
+    p1.vel_x = 0;
+    p1.vel_y = 0;
+    anim_play(p1, ANIM_PLAYER_IDLE);
+
+    ammo_count = START_AMMO;
+#if ARENA_SCROLL
+    // The arena is built at runtime, so the ammo icons have to be drawn into its top HUD.
+    ammo_shown = 0;
+    ammo_display_update();
+#else
+    ammo_shown = START_AMMO;
+#endif
+
+    waves_start();
+
+    audio_play_song(SONG_GAMEPLAY);
 
-            // Clear out all entities
-            for (unsigned char i = 0; i < NUM_ENTITIES; ++i)
-            {
-                ActiveEntities[i].cur_state = Entity_States::UNUSED;
-            }
+    ppu_on_all();
+}
 
-            // Reset player position and state
-            p1.cur_state = Entity_States::ACTIVE;
-            p1.x = 128 - 8;
-            p1.y = 120 - 16;
-            p1.vel_x = 0;
-            p1.vel_y = 0;
-            p1.anim_counter = 0;
-            p1.anim_frame = 0;
+// PPU mask for gameplay, put back after the zapper scan turns the background off.
+constexpr uint8_t GAMEPLAY_MASK = MASK_SPR | MASK_BG | MASK_EDGE_BG | MASK_EDGE_SPR;
 
-            ammo_count = 3;
+static void exit_state_gameplay()
+{
+    audio_stop_song();
 
-            enemy_spawn_timer = ENEMY_SPAWN_TIME;
-            ammo_spawn_timer = AMMO_SPAWN_TIME;
+    // The zapper scan is dropped with the state, and may have left the background off.
+    ppu_mask(GAMEPLAY_MASK);
+}
 
-            for (uint8_t i = 0; i < ammo_count; ++i)
-            {
-                vram_adr(NTADR_A(29 - i, 27));
-                vram_put(0x05); // bullet icon
-            }
+static void enter_state_gameover()
+{
+    oam_clear();
+    arena_reset_camera();
+    screen_show(screen_gameover_hud.rle);
+    
+    if (score > hiscore)
+    {
+        render_string(screen_nmt(), 3, 2,  "NEW HIGH SCORE"_l);
 
-            ppu_on_all();
-            break;
-        }
+        // NEW HIGH SCORE
+        hiscore = score;
+        is_highscore = true;
 
-        case Game_States::STATE_GAMEOVER:
-        {
-            ppu_off();
-            oam_clear();
-            vram_adr(NAMETABLE_A);
-            vram_unrle(screen_gameover);
-            
-            if (score > hiscore)
-            {
-                render_string(Nametable::A, 3, 2,  "NEW HIGH SCORE"_l);
+        palfx_start_cycle(&highscore_cycle);
+    }   
 
-                // NEW HIGH SCORE
-                hiscore = score;
-                is_highscore = true;
-            }   
-            
-            render_string(Nametable::A, 8, 196/8,  "Score"_l);
+    Letter score_digits[4] = { 
+        (Letter)4,
+        (Letter)((score / 100) % 10), 
+        (Letter)((score / 10) % 10), 
+        (Letter)(score % 10) 
+    };
 
-            Letter score_digits[4] = { 
-                (Letter)4,
-                (Letter)((score / 100) % 10), 
-                (Letter)((score / 10) % 10), 
-                (Letter)(score % 10) 
-            };
+    render_letters(screen_nmt(), (128 + 24)/8, 196/8, score_digits);   
 
-            render_string(Nametable::A, (128 + 24)/8, 196/8, score_digits);   
+    ppu_on_all();
+}
 
-            ppu_on_all();
-            break;
-        }
-    }
+static void exit_state_gameover()
+{
+    // Stop the high score flashing, the next screen uploads a fresh palette.
+    palfx_stop_cycles();
 }
 
 void update_state_title()
 {
     if (pad_pressed & (PAD_A | PAD_START) || (zapper_pressed && zapper_ready)) 
     {
-        goto_state(STATE_TUTORIAL);
+        request_state(STATE_TUTORIAL);
         return;
     }
 }
@@ -425,7 +556,7 @@ void update_state_tutorial()
 
     if (pad_pressed & (PAD_A | PAD_START) || (zapper_pressed && zapper_ready)) 
     {
-        goto_state(STATE_GAMEPLAY);
+        request_state(STATE_GAMEPLAY);
         return;
     }
 }
@@ -436,6 +567,8 @@ constexpr fs8_8 p1_BRAKING_FORCE = 0.1_s8_8;
 
 constexpr uint8_t WALL_OFFSET = 8;
 constexpr uint8_t WALL_OFFSET_RIGHT = 256 - WALL_OFFSET - 16 - 3;
+// The gameplay arena can be wider than the screen (ARENA_SCROLL), the tutorial is always a single screen.
+constexpr int16_t ARENA_WALL_OFFSET_RIGHT = ARENA_WIDTH - WALL_OFFSET - 16 - 3;
 constexpr uint8_t WALL_OFFSET_BOTTOM = 240 - 32 - 8 - 3;
 
 void update_player()
@@ -519,10 +652,12 @@ void update_player()
     }
     if (input & PAD_RIGHT)
     {
+        int16_t wall_right = (cur_state == STATE_GAMEPLAY) ? ARENA_WALL_OFFSET_RIGHT : WALL_OFFSET_RIGHT;
+
         // did we hit a wall?
-        if (p1.x.as_i() >= WALL_OFFSET_RIGHT)
+        if (p1.x.as_i() >= wall_right)
         {
-            p1.x = WALL_OFFSET_RIGHT;
+            p1.x = wall_right;
             p1.vel_x = 0;
         }
     }
@@ -557,126 +692,58 @@ void update_player()
         }
     }
 
-    ++p1.anim_counter;
-
-    if (p1.anim_counter > 5)
-    {
-        p1.anim_counter = 0;
-        ++p1.anim_frame;
-
-        if (p1.anim_frame > 1)
-        {
-            p1.anim_frame = 0;
-        }
-    }
-
-    uint8_t facing_offset = 0;
-    if (p1.facing_left)
-    {
-        facing_offset = 3;
-    }
-
+    // The walk clips line up frame by frame, so turning around doesn't restart the walk cycle.
     if (move_input_pressed)
     {
-        oam_meta_spr(p1.x.as_i(), p1.y.as_i(), metaspr_list[3 + facing_offset + p1.anim_frame]);
+        anim_set_clip(p1, p1.facing_left ? ANIM_PLAYER_WALK_LEFT : ANIM_PLAYER_WALK);
     }
     else
     {
-        oam_meta_spr(p1.x.as_i(), p1.y.as_i(), metaspr_list[5 + facing_offset]);
+        anim_set_clip(p1, p1.facing_left ? ANIM_PLAYER_IDLE_LEFT : ANIM_PLAYER_IDLE);
     }
 
-}
+    // The camera always keeps the player on screen.
+    uint8_t screen_x = (uint8_t)(p1.x.as_i() - camera_x);
 
-void update_enemy(Entity& Object)
-{
-    constexpr fs8_8 MAX_SPEED = 5.0_s8_8;
-    constexpr fs8_8 ACCELERATION = 0.01_s8_8;
+    metasprite(screen_x, p1.y.as_i(), metaspr_list[anim_metasprite(p1)]);
 
-    if (p1.x.as_i() < Object.x.as_i())
-    {
-        if (Object.vel_x > -MAX_SPEED) 
-        {
-            Object.vel_x -= ACCELERATION;
-        }   
-    }
-    else if (p1.x.as_i() > Object.x.as_i())
-    {
-        if (Object.vel_x < MAX_SPEED) 
-        {
-            Object.vel_x += ACCELERATION;
-        }
-    }
+}
 
-    if ((p1.y.as_i() + 16) < Object.y.as_i())
-    {
-        if (Object.vel_y > -MAX_SPEED) 
-        {
-            Object.vel_y -= ACCELERATION;
-        }
-    }
-    else if ((p1.y.as_i() + 16) > Object.y.as_i())
-    {
-        if (Object.vel_y < MAX_SPEED) 
-        {
-            Object.vel_y += ACCELERATION;
-        }
-    }            
+void update_enemy(Entity& Object, bool retarget)
+{
+    const EnemyBehavior& behavior = enemy_behaviors[Object.kind];
 
-    constexpr uint8_t SCREEN_BORDER = 8;
-    // If approaching border of the screen, reverse direction.
-    // Also cut the velocity in half.
-    if (Object.vel_x < 0 && Object.x.as_i() < SCREEN_BORDER)
-    {
-        Object.vel_x = MABS(Object.vel_x) / 2;
-    }
-    else if (Object.vel_x > 0 && Object.x.as_i() + 16 > (256 - SCREEN_BORDER))
-    {
-        Object.vel_x = -MABS(Object.vel_x) / 2;
-    }
-    // Also for the y axis which is 240 pixels high.
-    if (Object.vel_y < 0 && Object.y.as_i() < SCREEN_BORDER)
-    {
-        Object.vel_y = MABS(Object.vel_y) / 2;
-    }
-    else if (Object.vel_y > 0 && Object.y.as_i() + 16 > (240 - SCREEN_BORDER))
+    // Only a slice of the enemies make new decisions each frame, but they all keep moving.
+    if (retarget)
     {
-        Object.vel_y = -MABS(Object.vel_y) / 2;
+        enemy_retarget(Object);
     }
 
-    Object.x += Object.vel_x;
-    Object.y += Object.vel_y;
+    enemy_integrate(Object);
 
-    // Is the center point of the entity colliding with the player?
+    // Are the player's feet within the enemy's hitbox?
     // Note: The player and entity have top left origins.
     //       The player is 32x16, and we want to collide with the
     //       bottom 16x16 area, so we offset the player's y position by 16.
-    if (   (p1.x.as_i() + 8 >= Object.x.as_i())
-        && (p1.x.as_i() <= Object.x.as_i() + 8)
-        && (p1.y.as_i() + 16 + 8 >= Object.y.as_i())
-        && (p1.y.as_i() + 16 <= Object.y.as_i() + 8))
+    const uint8_t hitbox = behavior.hitbox_size;
+    if (   (p1.x.as_i() + hitbox >= Object.x.as_i())
+        && (p1.x.as_i() <= Object.x.as_i() + hitbox)
+        && (p1.y.as_i() + 16 + hitbox >= Object.y.as_i())
+        && (p1.y.as_i() + 16 <= Object.y.as_i() + hitbox))
     {
-        // Collision detected, go to game over state.
-        goto_state(STATE_GAMEOVER);
+        // Collision detected, go to game over state at the end of the frame.
+        request_state(STATE_GAMEOVER);
         return;
     }
 
-    ++Object.anim_counter;
-
-    if (Object.anim_counter > 5)
+    uint8_t screen_x;
+    if (arena_to_screen(Object.x.as_i(), 16, screen_x))
     {
-        Object.anim_counter = 0;
-        ++Object.anim_frame;
-
-        if (Object.anim_frame > 1)
-        {
-            Object.anim_frame = 0;
-        }
+        metasprite(
+            screen_x, 
+            Object.y.as_i(), 
+            metaspr_list[anim_metasprite(Object)]);
     }
-
-    oam_meta_spr(
-        Object.x.as_i(), 
-        Object.y.as_i(), 
-        metaspr_list[1 + Object.anim_frame]);
 }
 
 void update_ammo_pickup(Entity& Object)
@@ -700,53 +767,143 @@ void update_ammo_pickup(Entity& Object)
 
     if (isOverlap)
     {
-        // Give ammo and update this location on the ammo count display.
+        // Give ammo, the icon is drawn by ammo_display_update().
         if (ammo_count < MAX_AMMO) // this should always pass
         {
-            // Update the screen first so that we draw an ammo on the currently
-            // empty slot.
-            one_vram_buffer(0x05, get_ppu_addr(0, (29 - ammo_count) * 8, (27 * 8)));
             ++ammo_count;
 
+            audio_play_sfx(SFX_PICKUP);
+            particles_burst((uint8_t)(Object.x.as_i() - camera_x), Object.y.as_i(), PARTICLE_EFFECT_PICKUP_FLASH);
+
             Object.cur_state = Entity_States::UNUSED;
         }
     }
 
-    ++Object.anim_counter;
-
-    if (Object.anim_counter > 5)
+    uint8_t screen_x;
+    if (arena_to_screen(Object.x.as_i(), AMMO_WIDTH, screen_x))
     {
-        Object.anim_counter = 0;
-        ++Object.anim_frame;
+        oam_spr(screen_x, Object.y.as_i(), 0x05, 2); // Simple single-sprite bullet icon
+    }
+}
 
-        if (Object.anim_frame > 1)
+// The enemy the zapper scan is checking this frame, drawn as a white box instead of all the other sprites.
+static bool scan_box_shown;
+static uint8_t scan_box_x;
+static uint8_t scan_box_y;
+static uint8_t scan_index;
+
+// Checks every enemy on screen against the zapper after a shot, one per frame: each enemy's box is shown for a
+// frame with the background off, and the light sensor is read while that frame is drawn. The game keeps running
+// meanwhile, only its sprites are hidden (see zapper_scan_draw).
+static Task_Status zapper_scan(Task& task)
+{
+    TASK_BEGIN(task);
+    scan_box_shown = false;
+    for (scan_index = 0; scan_index < NUM_ENTITIES; ++scan_index)
+    {
+        // Enemies that are off screen can't be shot.
+        if (ActiveEntities[scan_index].cur_state == Entity_States::UNUSED 
+            || ActiveEntities[scan_index].type != ENTITY_TYPE_ENEMY
+            || !arena_to_screen(ActiveEntities[scan_index].x.as_i(), 16, scan_box_x))
         {
-            Object.anim_frame = 0;
+            continue;
+        }
+        scan_box_y = ActiveEntities[scan_index].y.as_i();
+        scan_box_shown = true;
+
+        // The box goes out with this frame's sprites, and is on screen during the next one. Tasks run right
+        // after NMI (the split wait is skipped during the scan), so the read starts at the top of that frame.
+        TASK_YIELD(task);
+        cpu_meter(CPU_METER_ZAPPER);
+        // Reading the sensor takes most of the frame. That's on purpose, not lag.
+        lag_ignore_frame();
+        scan_box_shown = false;
+
+        // It may have been removed while its box was up, and the slot taken by something else (like the ammo
+        // dropped by an enemy hit earlier in this scan).
+        if (ActiveEntities[scan_index].cur_state != Entity_States::UNUSED
+            && ActiveEntities[scan_index].type == ENTITY_TYPE_ENEMY
+            && zap_read(1))
+        {
+            audio_play_sfx(SFX_HIT);
+            event_log(EVENT_HIT, scan_index, scan_box_x, scan_box_y);
+            particles_burst(scan_box_x + 4, scan_box_y + 4, PARTICLE_EFFECT_HIT_SPARK);
+            popup_show(scan_box_x, scan_box_y, "+1"_l, POPUP_STYLE_SCORE);
+
+            // increase score and draw it
+            ++score;
+            if (score > 999) score = 999;
+
+            // reset the wave timer so that the new enemy doesn't spawn immediately
+            waves_enemy_killed();
+
+#if !BIG_SCORE
+            // Create a temp letter array to hold the score digits
+            Letter score_digits[4] = { 
+                (Letter)4,
+                (Letter)((score / 100) % 10), 
+                (Letter)((score / 10) % 10), 
+                (Letter)(score % 10) 
+            };
+
+            render_letters(screen_nmt(), 2, 2, score_digits);
+#endif
+
+            ActiveEntities[scan_index].cur_state = Entity_States::UNUSED;
+
+            try_spawn_ammo_pickup(true, scan_box_x + 6, scan_box_y + 4);
+
+            // keep going, multiple enemies can be hit with one shot
         }
     }
 
-    oam_spr(Object.x.as_i(), Object.y.as_i(), 0x05, 2); // Simple single-sprite bullet icon
+    ppu_mask(GAMEPLAY_MASK);
+    TASK_END(task);
+}
+
+// While the zapper scan is showing a box, it's the only sprite on screen.
+static void zapper_scan_draw()
+{
+    if (!scan_box_shown || !task_running(zapper_scan))
+    {
+        return;
+    }
+    oam_clear();
+    metasprite(scan_box_x, scan_box_y, metaspr_box_16_16_data);
 }
 
 void update_state_gameplay()
 {
+    // While the zapper scan has the screen, only the box it's checking is visible. The world waits for it
+    // instead of moving where the player can't see it (nobody can be hit while the screen is dark). The music
+    // and the animations keep going, and the HUD still catches up with the hits the scan scores.
+    if (task_running(zapper_scan))
+    {
+#if BIG_SCORE
+        big_number_update(score_display, score);
+#endif
+        ammo_display_update();
+        return;
+    }
+
+    cpu_meter(CPU_METER_PLAYER);
     update_player();
 
-    --enemy_spawn_timer;
+    cpu_meter(CPU_METER_WORLD);
 
-    if (enemy_spawn_timer == 0)
-    {
-        enemy_spawn_timer = ENEMY_SPAWN_TIME;
+    // Follow the player and stream in the next column of the arena.
+    uint16_t old_camera_x = camera_x;
+    arena_update();
+    int8_t scroll_dx = (int8_t)(camera_x - old_camera_x);
 
-        try_spawn_enemy();
+    // The wave script decides when and what to spawn.
+    WaveAction wave = waves_update();
+    if (wave.spawn_enemy)
+    {
+        try_spawn_enemy(wave.enemy_kind, wave.region);
     }
-
-    --ammo_spawn_timer;
-
-    if (ammo_spawn_timer == 0)
+    if (wave.spawn_ammo)
     {
-        ammo_spawn_timer = AMMO_SPAWN_TIME;
-
         try_spawn_ammo_pickup();
     }
 
@@ -768,34 +925,21 @@ void update_state_gameplay()
                 // ActiveEntities[i].y = start_y + ((uint8_t)rand() % (120 - 16));
 
                 // which of the 4 regions is the player in?
-                uint8_t x_region = (p1.x.as_i() / 128);
+                uint8_t x_region = ((p1.x.as_i() - camera_x) / 128);
                 uint8_t y_region = (p1.y.as_i() / 120);
 
-                // use it like this
-                //puts("x: ");
-                // puts("x,y regions:");
-                // putchar('0' + x_region);
-                // putchar(',');
-                // //puts(" y: ");
-                // putchar('0' + y_region);           
-                // puts("");
-
                 // pick a region from the area that exludes the one the player is
                 // in.
                 uint8_t area_choice = (uint8_t)(rand()) % 3;
 
-                // puts("area choice:");
-                // putchar('0' + area_choice);          
-                // puts("");                
+                event_log(EVENT_DEBUG_SPAWN, x_region, y_region, area_choice);
 
                 SpawnArea spawn_area = spawn_area_collections[x_region][y_region][area_choice];
 
-                ActiveEntities[i].x = spawn_area.start_x + ((uint8_t)rand() % (128 - 16));
+                ActiveEntities[i].x = camera_x + spawn_area.start_x + ((uint8_t)rand() % (128 - 16));
                 ActiveEntities[i].y = spawn_area.start_y + ((uint8_t)rand() % (120 - 16));                
 
-                ActiveEntities[i].vel_x = 0;
-                ActiveEntities[i].vel_y = 0;
-                ActiveEntities[i].anim_counter = 0;
+                enemy_spawn(ActiveEntities[i], ENEMY_KIND_BOT);
 
                 break;
             }
@@ -810,12 +954,19 @@ void update_state_gameplay()
 
     if (pad_pressed & PAD_SELECT)
     {
-        goto_state(STATE_GAMEOVER);
+        request_state(STATE_GAMEOVER);
         return;
     }   
 
+    // Which AI slice gets to re-target this frame. None of them do when the game is lagging,
+    // enemies keep moving along their current heading.
+    uint8_t ai_phase = lag_shed() ? AI_SLICES : (uint8_t)ticks16 & (AI_SLICES - 1);
+
+    cpu_meter(CPU_METER_ENTITIES);
+
     // Update all the entities and draw them to the screen.
-    for (unsigned char i = 0; i < NUM_ENTITIES; ++i)
+    // Stop as soon as one of them ends the game, the rest of the frame would be thrown away.
+    for (unsigned char i = 0; i < NUM_ENTITIES && !state_change_pending; ++i)
     {
         if (ActiveEntities[i].cur_state != Entity_States::UNUSED)
         {
@@ -823,7 +974,7 @@ void update_state_gameplay()
             {
                 case ENTITY_TYPE_ENEMY:
                 {
-                    update_enemy(ActiveEntities[i]);
+                    update_enemy(ActiveEntities[i], (i & (AI_SLICES - 1)) == ai_phase);
                     break;
                 }
 
@@ -839,98 +990,158 @@ void update_state_gameplay()
         }
     }
 
-    // Was the Zapper pressed this frame, but NOT pressed last frame.
-    if (zapper_pressed && zapper_ready && ammo_count > 0)
-    {   
-        // Decrease ammo count and update the display
-        --ammo_count;
-        // Clear the one ammo that was fired.
-        one_vram_buffer(0x00, get_ppu_addr(0, (29 - ammo_count) * 8, (27 * 8)));
-
-        // use the ppu mask to disable the background
-        ppu_mask(MASK_SPR);
-
-        // TODO: Needed?
-        ppu_wait_nmi();
+    if (state_change_pending)
+    {
+        return;
+    }
 
-        bool hit_detected = false;
+    cpu_meter(CPU_METER_OAM);
 
-        for (uint8_t i = 0; i < NUM_ENTITIES; ++i)
-        {
-            if (ActiveEntities[i].cur_state != Entity_States::UNUSED 
-                && ActiveEntities[i].type == ENTITY_TYPE_ENEMY)
-            {
-                oam_clear();
-                oam_meta_spr(ActiveEntities[i].x.as_i(), ActiveEntities[i].y.as_i(), metaspr_box_16_16_data);
+    // Move and draw all the projectiles in one batch each.
+    projectiles_update(scroll_dx);
+    projectiles_draw();
 
-                // NOTE: Must be here before zap_read, or else the zapper
-                //       will see the previous frames data.
-                ppu_wait_nmi();
+    // Popups are feedback the player should see, so they go before the particles.
+    popups_update();
 
-                hit_detected = zap_read(1);
-
-                if (hit_detected)
-                {
-                    // increase score and draw it
-                    ++score;
-                    if (score > 999) score = 999;
+    // Particles go last so they only get the sprites nobody else needed. Under load they're only
+    // drawn every other frame, which looks like the flicker they already do at the end of their life.
+    if (!lag_shed())
+    {
+        particles_update();
+    }
 
-                    // reset the timer so that the new enemy doesn't spawn immediately
-                    enemy_spawn_timer = ENEMY_SPAWN_TIME / 2;
+#if BIG_SCORE
+    // Only the digits that changed get redrawn. A redraw that doesn't fit in VRAM_BUF goes out on a later frame.
+    big_number_update(score_display, score);
+#endif
 
-                    // Create a temp letter array to hold the score digits
-                    Letter score_digits[4] = { 
-                        (Letter)4,
-                        (Letter)((score / 100) % 10), 
-                        (Letter)((score / 10) % 10), 
-                        (Letter)(score % 10) 
-                    };
+    // Was the Zapper pressed this frame, but NOT pressed last frame. A shot can't start while the last one is
+    // still being checked.
+    if (zapper_pressed && zapper_ready && ammo_count > 0 && !task_running(zapper_scan))
+    {   
+        // Decrease ammo count, the icon is cleared by ammo_display_update().
+        --ammo_count;
 
-                    render_string(Nametable::A, 2, 2, score_digits);
+        if (ammo_count == 0)
+        {
+            // Centered on the screen, 6 letters of 16 pixels.
+            popup_show(128 - 48, 104, "RELOAD"_l, POPUP_STYLE_WARNING);
+        }
 
-                    ActiveEntities[i].cur_state = Entity_States::UNUSED;
+        audio_play_sfx(SFX_SHOT);
+        event_log(EVENT_SHOT, ammo_count);
 
-                    try_spawn_ammo_pickup(true, ActiveEntities[i].x.as_i() + 6, ActiveEntities[i].y.as_i() + 4);
-                    
-                    //break; // allow multiple enemies to be hit with one shot
-                }
-            }
-        }
+        // use the ppu mask to disable the background
+        ppu_mask(MASK_SPR);
 
-        ppu_mask(MASK_SPR | MASK_BG | MASK_EDGE_BG | MASK_EDGE_SPR);
+        task_start(zapper_scan);
     }        
+
+    // Only the icons that changed are redrawn, and one that doesn't fit in this frame's buffer goes out later.
+    ammo_display_update();
 }
 
 void update_state_gameover()
 {
-    if (is_highscore)
-    {
-        pal_col(3, 0x31 + ((ticks_in_state / 4) % 0x0b));
-    }
-
     if (pad_pressed & (PAD_A | PAD_START) || (zapper_pressed && zapper_ready)) 
     {
-        if (ticks_in_state < 60) return;
+        if (ticks_in_state < SECONDS(1)) return;
         
-        goto_state(STATE_TITLE);
+        request_state(STATE_TITLE);
         return;
     }
 }
 
+/**
+ * @brief Per state callbacks. `enter` runs with the screen faded out, after the previous state's `exit`.
+ *        `update` runs once per frame. Every entry must be filled in (use state_noop) so dispatch is
+ *        a plain indirect call with no checks.
+ *
+ *        `screen` is the background the state shows, and `prepare` the one to get ready in the hidden nametable
+ *        while the state runs: the screen of the state that usually comes next (see screen.hpp).
+ */
+struct StateDescriptor
+{
+    void (*enter)();
+    void (*update)();
+    void (*exit)();
+    const unsigned char* screen;
+    const unsigned char* prepare;
+};
+
+// Indexed by Game_States, so keep it in the same order as the enum.
+static constexpr StateDescriptor state_table[STATE_COUNT] =
+{
+    // STATE_TITLE
+    { enter_state_title, update_state_title, state_noop, screen_title, screen_tutorial.rle },
+    // STATE_TUTORIAL
+    { enter_state_tutorial, update_state_tutorial, state_noop, screen_tutorial.rle, screen_gameplay_hud.rle },
+    // STATE_GAMEPLAY
+    { enter_state_gameplay, update_state_gameplay, exit_state_gameplay, screen_gameplay_hud.rle, screen_gameover_hud.rle },
+    // STATE_GAMEOVER
+    { enter_state_gameover, update_state_gameover, exit_state_gameover, screen_gameover_hud.rle, screen_title },
+};
+
+// Perform the transition that was requested during this frame.
+static void apply_state_change()
+{
+    state_change_pending = false;
+
+    event_log(EVENT_STATE_CHANGE, cur_state, next_state);
+
+    // Whatever the old state still had going is dropped with it.
+    tasks_clear();
+    state_table[cur_state].exit();
+
+    // Fade the old screen out before tearing it down, and fade the new one in once its ready.
+    // If the next screen is already waiting in the hidden nametable, it's a straight cut instead.
+    bool instant = screen_is_prepared(state_table[next_state].screen);
+    if (!instant)
+    {
+        palfx_fade_out_and_wait();
+    }
+
+    ticks_in_state = 0;
+    cur_state = next_state;
+    state_table[cur_state].enter();
+
+    if (!instant)
+    {
+        palfx_fade_in();
+    }
+
+    screen_prepare(state_table[cur_state].prepare);
+
+    // The fade and the new state's setup took frames on purpose, don't try to catch them up.
+    clock_resync();
+}
+
 // ENTRY POINT FOR THE PROGRAM
 int main() 
 {
   
     // Tell NMI to update graphics using the VRAM_BUFFER provided by nesdoug library
     set_vram_buffer();
+
+    // Start up the music engine, from here on it updates itself at the end of every NMI.
+    audio_init();
     
     // Start off by disabling the PPU rendering, allowing us to upload data safely to the nametable (background)
     ppu_off();
 
+    // Compare the asm kernels against their C++ versions (only in KERNEL_CHECK builds).
+    kernel_check();
+    // Draw edge case lines on the canvas and check the clipping (only in CANVAS_CHECK builds).
+    canvas_check();
+
     // Clear all sprites off screen. RAM state is random on boot so there is a bunch of garbled sprites on screen
     // by default.
     oam_clear();
 
+    // Mark every projectile slot unused, zeroed RAM would look like projectiles at 0, 0.
+    projectiles_clear();
+
     // Set to use 8x8 sprite mode. I doubt 8x16 sprite mode will help much with the game genie CHR :)
     oam_size(0);
 
@@ -952,7 +1163,12 @@ int main()
     vram_unrle(nametable);
 
 
-    goto_state(Game_States::STATE_TITLE);
+    // PAL or NTSC, before the first state so it starts counting from there. The arena split also needs it to
+    // time its wait.
+    clock_init();
+
+    request_state(Game_States::STATE_TITLE);
+    apply_state_change();
 
     
     // Turn on the screen, showing both the background and sprites
@@ -961,9 +1177,15 @@ int main()
     // Now time to start the main game loop
     while (true) 
     {
-        // Count frames elapsed since boot (before reading input so timing differences matter for seeding)
-        ++ticks16;
-        ++ticks_in_state;
+        lag_frame_begin();
+
+        // Lets a lower priority sound effect play again once the last one has finished.
+        audio_update();
+
+        // 1 tick a frame on NTSC, an extra one every 5th frame on PAL, see clock.hpp.
+        uint8_t steps = clock_steps();
+
+        cpu_meter(CPU_METER_INPUT);
         
         // Get the input state.
         // NOTE: This will return the "trigger/pressed" state, but pad_state
@@ -971,8 +1193,16 @@ int main()
         pad_pressed = pad_trigger(0);
         pad = pad_state(0);
 
-        // Once a frame, clear the sprites out so that we don't have leftover sprites.
-        oam_clear();
+        // Wait for the split line (if there is one) before doing the bulk of the frame's work.
+        // Anything above this line runs during the busy wait for free, see split_last_wait().
+        // The zapper scan turns the background off, so there's no sprite 0 hit to wait for. Waiting out the
+        // timeout would also push its sensor read past the top of the play area.
+        cpu_meter(CPU_METER_IDLE);
+        if (!task_running(zapper_scan))
+        {
+            split_wait();
+        }
+        cpu_meter(CPU_METER_INPUT);
 
         // XOR with the last frame to make sure this is a NEW press. In other words,
         // if pad2_zapper was 1 last frame (pressed), zapper_ready will be 0 (not ready).
@@ -981,34 +1211,67 @@ int main()
 		// is trigger pulled?
 		zapper_pressed = zap_shoot(1);
 
-        switch (cur_state) 
+        // Pick up any work that's spread over several frames, as close to NMI as possible. The zapper scan
+        // needs to read the sensor while the frame is drawn.
+        tasks_run();
+
+        for (uint8_t step = 0; step < steps; ++step)
         {
-            case STATE_TITLE:
-            {
-                update_state_title();
-                break;
-            }
+            // Count ticks elapsed since boot (the RNG is seeded from this when the game starts)
+            ++ticks16;
+            ++ticks_in_state;
 
-            case STATE_TUTORIAL:
-            {
-                update_state_tutorial();
-                break;
-            }
+            // Once a tick, clear the sprites out so that we don't have leftover sprites.
+            cpu_meter(CPU_METER_OAM);
+            oam_clear();
+            // Sprite 0 has to be the first sprite of the frame.
+            split_place_sprite0();
 
-            case STATE_GAMEPLAY:
+            // Step every animation in one go, the state updates only pick which clip plays.
+            // Under load the animations run at half speed instead.
+            if (!lag_shed())
             {
-                update_state_gameplay();
-                break;
+                anim_tick_all();
             }
-        
-            case STATE_GAMEOVER:
+
+            state_table[cur_state].update();
+
+            // The rest of the state change happens below, stop here.
+            if (state_change_pending)
             {
-                update_state_gameover();
                 break;
             }
+
+            // A new press only counts for the first tick of the frame, the held state stays.
+            pad_pressed = 0;
+            zapper_ready = 0;
         }
+
+        // Hide the game's sprites while the zapper scan needs the screen.
+        zapper_scan_draw();
+
+        // Only the frame's own work is measured, a state change turns the screen off anyway.
+        lag_frame_end();
+
+        event_log_flush();
+
+        // Switch states now that the frame's work is done, so nothing runs against a half torn down state.
+        if (state_change_pending)
+        {
+            apply_state_change();
+        }
+
+        // Decode a bit more of the next screen into the hidden nametable, unless the frame's already too full.
+        if (!lag_shed())
+        {
+            screen_prepare_step();
+        }
+
+        // Any palette changes for this frame get made here so they go out in a single upload.
+        palfx_update();
         
         // All done! Wait for the next frame before looping again
+        cpu_meter(CPU_METER_IDLE);
         ppu_wait_nmi();
     }
     // Tell the compiler we are never stopping the game loop!
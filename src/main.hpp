@@ -5,8 +5,27 @@
 #include <fixed_point.h>
 using namespace fixedpoint_literals;
 
+/**
+ * @brief Tag frequently accessed globals with this to place them in zeropage, where every access is
+ *        a byte smaller and usually a cycle faster. Zeropage is shared with the compiler and the libraries,
+ *        so keep this for the hottest variables. The build prints a report (zp-report.txt) of every tagged
+ *        variable and how many instructions now use zeropage addressing for it.
+ */
+#define ZP_HOT __zeropage
+
+/**
+ * @brief Fixed point type for horizontal world positions. The scrolling arena (ARENA_SCROLL) is wider
+ *        than the screen so it needs more than 8 integer bits, the single screen arena doesn't.
+ */
+#if ARENA_SCROLL
+using world_fixed = fu16_8;
+#else
+using world_fixed = fu8_8;
+#endif
+
 #define NUM_ENTITIES 8
 #define MAX_AMMO 10
+#define START_AMMO 3
 
 // Custom MIN/MAX macros that do not double evaluate the inputs
 #define MMAX(a,b) \
@@ -42,8 +61,8 @@ class Entity
 {
 public:
 
-    // position
-    fu8_8 x = 0;
+    // position, x is in world space
+    world_fixed x = 0;
     fu8_8 y = 0;
 
     // velocity
@@ -53,10 +72,19 @@ public:
     Entity_States cur_state = Entity_States::UNUSED;
     Entity_Types type = ENTITY_TYPE_NONE;
 
-    uint8_t anim_counter = 0;
-    uint8_t anim_frame = 0;
+    // Anim_Clips entry that's playing, and the packed frame/timer state for it (see anim.hpp).
+    uint8_t anim_clip = 0;
+    uint8_t anim = 0;
 
     bool facing_left = false;
+
+    // Enemy_Kinds entry used to look up this entity's behavior (enemies only).
+    uint8_t kind = 0;
+
+    // Last AI decision for which way to accelerate on each axis (-1, 0 or 1). Re-evaluated
+    // only every few frames, but applied every frame.
+    int8_t steer_x = 0;
+    int8_t steer_y = 0;
 };
 
 enum Game_States
@@ -65,8 +93,21 @@ enum Game_States
     STATE_TUTORIAL,
     STATE_GAMEPLAY,
     STATE_GAMEOVER,
+    STATE_COUNT,
 };
 
 extern Game_States cur_state;
 
+// Player object.
+extern ZP_HOT Entity p1;
+
+extern Entity ActiveEntities[NUM_ENTITIES];
+
+/**
+ * @brief Ask to switch to a new state. The current frame finishes (callers should stop doing work once
+ *        is_state_change_pending() is true) and the transition happens at the end of the frame.
+ */
+void request_state(Game_States new_state);
+bool is_state_change_pending();
+
 #endif /* B78B5263_80F5_427B_82AB_4E62FB56CCA0 */
@@ -0,0 +1,43 @@
+#include "metasprite.hpp"
+
+#include <cstdint>
+
+// neslib's shadow OAM, DMA'd to the PPU every NMI.
+static volatile uint8_t* const OAM_BUF = (volatile uint8_t*)0x0200;
+
+// Metasprite end marker, see metasprites.h
+constexpr int8_t METASPRITE_END = (int8_t)0x80;
+
+// When the asm version is picked it takes the real name, see ca65/kernels.s.
+#if METASPRITE_ASM
+extern "C" uint8_t draw_metasprite_cpp(uint8_t x, uint8_t y, const int8_t* data, uint8_t oam_offset)
+#else
+extern "C" uint8_t draw_metasprite(uint8_t x, uint8_t y, const int8_t* data, uint8_t oam_offset)
+#endif
+{
+    // Each sprite is x offset, y offset, tile, attributes. OAM wants y, tile, attributes, x.
+    // Offsets are added with 8 bit wrap around, the same as neslib.
+    while (data[0] != METASPRITE_END)
+    {
+        OAM_BUF[oam_offset + 0] = y + (uint8_t)data[1];
+        OAM_BUF[oam_offset + 1] = (uint8_t)data[2];
+        OAM_BUF[oam_offset + 2] = (uint8_t)data[3];
+        OAM_BUF[oam_offset + 3] = x + (uint8_t)data[0];
+        oam_offset += 4;
+        data += 4;
+    }
+    return oam_offset;
+}
+
+uint8_t oam_free_sprites()
+{
+    // oam_get() is the byte offset of the next free sprite. Once all 64 sprites are used it wraps back to 0,
+    // the same as when nothing has been drawn yet. oam_clear() hides every sprite (y = 0xff), so sprite 0
+    // tells the two apart.
+    uint8_t offset = oam_get();
+    if (offset != 0)
+    {
+        return (uint8_t)(0 - offset) >> 2;
+    }
+    return (OAM_BUF[0] == 0xff) ? 64 : 0;
+}
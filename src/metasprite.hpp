@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <neslib.h>
+
+/**
+ * @brief Draw a metasprite (in the neslib format used by metasprites.h) into the shadow OAM at `oam_offset`.
+ *        Same result as neslib's `oam_meta_spr`, but the OAM offset is passed in and returned so the
+ *        hand written version in ca65/kernels.s (METASPRITE_ASM) doesn't depend on neslib's internals.
+ *
+ * @return the OAM offset after the last sprite
+ */
+extern "C" uint8_t draw_metasprite(uint8_t x, uint8_t y, const int8_t* data, uint8_t oam_offset);
+
+#if METASPRITE_ASM
+// The reference version, kept around for KERNEL_CHECK.
+extern "C" uint8_t draw_metasprite_cpp(uint8_t x, uint8_t y, const int8_t* data, uint8_t oam_offset);
+#endif
+
+/**
+ * @brief Sprites still free in OAM this frame, for the effects that only use whatever is left over.
+ */
+uint8_t oam_free_sprites();
+
+/**
+ * @brief Drop in for `oam_meta_spr` that goes through `draw_metasprite`.
+ */
+inline void metasprite(uint8_t x, uint8_t y, const int8_t* data)
+{
+    oam_set(draw_metasprite(x, y, data, oam_get()));
+}
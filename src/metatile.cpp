@@ -2,6 +2,7 @@
 #include <neslib.h>
 
 #include "metatile.hpp"
+#include "vram_fast.hpp"
 #include <cstdint>
 
 // Include the VRAM buffer and the VRAM_INDEX so we can write directly into the buffer ourselves.
@@ -10,7 +11,61 @@ extern volatile __zeropage uint8_t VRAM_INDEX;
 extern volatile __zeropage uint8_t NAME_UPD_ENABLE;
 
 
+#if VRAM_FAST
+
+// Same tiles as below, but as packets for the unrolled upload in ca65/vram_fast.s. The opcode goes in last
+// and NMI skips the buffer while VRAM_FAST_LOCK is set, so it never sees half a packet.
 extern "C" void draw_metatile_2_2(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_2* tile) {
+    if (vram_fast_free() < 8) {
+        return;
+    }
+    VRAM_FAST_LOCK = 1;
+    auto idx = VRAM_FAST_INDEX;
+    int ppuaddr = 0x2000 | (((uint8_t)nmt) << 8) | (((y) << 5) | (x));
+    VRAM_FAST_BUF[idx+1] = MSB(ppuaddr);
+    VRAM_FAST_BUF[idx+2] = LSB(ppuaddr);
+    VRAM_FAST_BUF[idx+3] = LEFT_TILE(tile->top);
+    VRAM_FAST_BUF[idx+4] = LEFT_TILE(tile->bot);
+    VRAM_FAST_BUF[idx+5] = RIGHT_TILE(tile->top);
+    VRAM_FAST_BUF[idx+6] = RIGHT_TILE(tile->bot);
+    VRAM_FAST_BUF[idx+7] = VRAM_FAST_EOF;
+    VRAM_FAST_BUF[idx+0] = VRAM_FAST_METATILE_2_2;
+    VRAM_FAST_INDEX = idx + 7;
+    VRAM_FAST_LOCK = 0;
+}
+
+extern "C" void draw_metatile_2_3(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_3* tile) {
+    if (vram_fast_free() < 10) {
+        return;
+    }
+    VRAM_FAST_LOCK = 1;
+    auto idx = VRAM_FAST_INDEX;
+    int ppuaddr = 0x2000 | (((uint8_t)nmt) << 8) | (((y) << 5) | (x));
+    VRAM_FAST_BUF[idx+1] = MSB(ppuaddr);
+    VRAM_FAST_BUF[idx+2] = LSB(ppuaddr);
+    VRAM_FAST_BUF[idx+3] = LEFT_TILE(tile->top_top);
+    VRAM_FAST_BUF[idx+4] = LEFT_TILE(tile->top_bot);
+    VRAM_FAST_BUF[idx+5] = LEFT_TILE(tile->bot_top);
+    VRAM_FAST_BUF[idx+6] = RIGHT_TILE(tile->top_top);
+    VRAM_FAST_BUF[idx+7] = RIGHT_TILE(tile->top_bot);
+    VRAM_FAST_BUF[idx+8] = RIGHT_TILE(tile->bot_top);
+    VRAM_FAST_BUF[idx+9] = VRAM_FAST_EOF;
+    VRAM_FAST_BUF[idx+0] = VRAM_FAST_METATILE_2_3;
+    VRAM_FAST_INDEX = idx + 9;
+    VRAM_FAST_LOCK = 0;
+}
+
+#else
+
+// When the asm versions are picked (METATILE_ASM) they take the real names, see ca65/kernels.s.
+// These stay around as the reference for KERNEL_CHECK.
+#if METATILE_ASM
+#define METATILE_KERNEL(name) name##_cpp
+#else
+#define METATILE_KERNEL(name) name
+#endif
+
+extern "C" void METATILE_KERNEL(draw_metatile_2_2)(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_2* tile) {
     auto idx = VRAM_INDEX;
     int ppuaddr_left = 0x2000 | (((uint8_t)nmt) << 8) | (((y) << 5) | (x));
     int ppuaddr_right = ppuaddr_left + 1;
@@ -28,7 +83,7 @@ extern "C" void draw_metatile_2_2(Nametable nmt, uint8_t x, uint8_t y, const Met
     VRAM_INDEX += 10;
 }
 
-extern "C" void draw_metatile_2_3(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_3* tile) {
+extern "C" void METATILE_KERNEL(draw_metatile_2_3)(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_3* tile) {
     auto idx = VRAM_INDEX;
     int ppuaddr_left = 0x2000 | (((uint8_t)nmt) << 8) | (((y) << 5) | (x));
     int ppuaddr_right = ppuaddr_left + 1;
@@ -48,6 +103,8 @@ extern "C" void draw_metatile_2_3(Nametable nmt, uint8_t x, uint8_t y, const Met
     VRAM_INDEX += 12;
 }
 
+#endif
+
 extern "C" void draw_metatile_4_4(Nametable nmt, uint8_t x, uint8_t y, const Metatile_4_4* tile) {
     draw_metatile_2_2(nmt, x, y, &tile->topleft);
     draw_metatile_2_2(nmt, x+2, y, &tile->topright);
@@ -48,6 +48,12 @@ void draw_metatile_2_2(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_2*
 void draw_metatile_2_3(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_3* tile);
 void draw_metatile_4_4(Nametable nmt, uint8_t x, uint8_t y, const Metatile_4_4* tile);
 
+#if METATILE_ASM
+// The C++ versions of the asm kernels in ca65/kernels.s, kept around for KERNEL_CHECK.
+void draw_metatile_2_2_cpp(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_2* tile);
+void draw_metatile_2_3_cpp(Nametable nmt, uint8_t x, uint8_t y, const Metatile_2_3* tile);
+#endif
+
 consteval uint8_t get_tile_for_bits(uint8_t bits) {
     const uint8_t bits_to_tile[] = {
         // order for the bits is tl tr bl br
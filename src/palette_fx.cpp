@@ -0,0 +1,138 @@
+#include "palette_fx.hpp"
+#include "split.hpp"
+
+#include <cstdint>
+#include <neslib.h>
+
+struct CycleState
+{
+    const PaletteCycle* cycle;
+    uint8_t step;
+    uint8_t countdown;
+};
+
+static CycleState cycles[PALFX_MAX_CYCLES];
+
+static uint8_t brightness = PALFX_BRIGHTNESS_NORMAL;
+static uint8_t fade_target = PALFX_BRIGHTNESS_NORMAL;
+static uint8_t fade_frames_per_step = 0;
+static uint8_t fade_countdown = 0;
+
+void palfx_start_cycle(const PaletteCycle* cycle)
+{
+    // Prefer restarting the same cycle, otherwise take the first free slot.
+    uint8_t slot = PALFX_MAX_CYCLES;
+    for (uint8_t i = 0; i < PALFX_MAX_CYCLES; ++i)
+    {
+        if (cycles[i].cycle == cycle)
+        {
+            slot = i;
+            break;
+        }
+        if (cycles[i].cycle == nullptr && slot == PALFX_MAX_CYCLES)
+        {
+            slot = i;
+        }
+    }
+
+    if (slot == PALFX_MAX_CYCLES)
+    {
+        return;
+    }
+
+    // Park the cycle on its last color with one frame to go, so the next palfx_update wraps around and
+    // writes the first color along with every other palette change of the frame.
+    cycles[slot].cycle = cycle;
+    cycles[slot].step = cycle->length - 1;
+    cycles[slot].countdown = 1;
+}
+
+void palfx_stop_cycles()
+{
+    for (uint8_t i = 0; i < PALFX_MAX_CYCLES; ++i)
+    {
+        cycles[i].cycle = nullptr;
+    }
+}
+
+static void start_fade(uint8_t target, uint8_t frames_per_step)
+{
+    fade_target = target;
+    fade_frames_per_step = frames_per_step;
+    fade_countdown = frames_per_step;
+}
+
+void palfx_fade_in(uint8_t frames_per_step)
+{
+    palfx_set_brightness(PALFX_BRIGHTNESS_BLACK);
+    start_fade(PALFX_BRIGHTNESS_NORMAL, frames_per_step);
+}
+
+void palfx_fade_out(uint8_t frames_per_step)
+{
+    start_fade(PALFX_BRIGHTNESS_BLACK, frames_per_step);
+}
+
+void palfx_set_brightness(uint8_t level)
+{
+    fade_target = level;
+    if (brightness != level)
+    {
+        brightness = level;
+        pal_bright(level);
+    }
+}
+
+bool palfx_is_fading()
+{
+    return brightness != fade_target;
+}
+
+uint8_t palfx_brightness()
+{
+    return brightness;
+}
+
+void palfx_update()
+{
+    for (uint8_t i = 0; i < PALFX_MAX_CYCLES; ++i)
+    {
+        CycleState& state = cycles[i];
+        if (state.cycle == nullptr)
+        {
+            continue;
+        }
+
+        // Count down instead of dividing a frame counter, and only touch the palette on a step.
+        if (--state.countdown != 0)
+        {
+            continue;
+        }
+        state.countdown = state.cycle->frames_per_step;
+
+        if (++state.step == state.cycle->length)
+        {
+            state.step = 0;
+        }
+        pal_col(state.cycle->pal_index, state.cycle->colors[state.step]);
+    }
+
+    if (brightness != fade_target && --fade_countdown == 0)
+    {
+        fade_countdown = fade_frames_per_step;
+        brightness += (brightness < fade_target) ? 1 : -1;
+        pal_bright(brightness);
+    }
+}
+
+void palfx_fade_out_and_wait()
+{
+    palfx_fade_out();
+    while (palfx_is_fading())
+    {
+        palfx_update();
+        ppu_wait_nmi();
+        // Keep the screen split while fading so the scrolled part doesn't jump.
+        split_wait();
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief A precomputed color sequence for a single palette entry.
+ *        Every `frames_per_step` frames the entry moves to the next color, wrapping at the end.
+ */
+struct PaletteCycle
+{
+    // Palette entry to animate, 0 - 31 (same numbering as `pal_col`)
+    uint8_t pal_index;
+    uint8_t frames_per_step;
+    uint8_t length;
+    const uint8_t* colors;
+};
+
+// How many cycles can run at the same time.
+constexpr uint8_t PALFX_MAX_CYCLES = 2;
+
+// neslib brightness levels used by `pal_bright`. 0 is black, 4 is the palette as uploaded.
+constexpr uint8_t PALFX_BRIGHTNESS_BLACK = 0;
+constexpr uint8_t PALFX_BRIGHTNESS_NORMAL = 4;
+
+// Default speed of fade in/out, a full fade takes 4 steps.
+constexpr uint8_t PALFX_FADE_FRAMES_PER_STEP = 2;
+
+/**
+ * @brief Start animating a palette entry. Restarts the cycle if it's already running.
+ *        The entry gets the first color on the next `palfx_update`.
+ *        If all slots are in use the request is ignored.
+ */
+void palfx_start_cycle(const PaletteCycle* cycle);
+
+/**
+ * @brief Stop all cycles. The palette entries keep whatever color they were last set to.
+ */
+void palfx_stop_cycles();
+
+/**
+ * @brief Fade from black up to the normal palette, or from the current brightness down to black.
+ */
+void palfx_fade_in(uint8_t frames_per_step = PALFX_FADE_FRAMES_PER_STEP);
+void palfx_fade_out(uint8_t frames_per_step = PALFX_FADE_FRAMES_PER_STEP);
+
+/**
+ * @brief Jump straight to a brightness level, cancelling any fade in progress.
+ */
+void palfx_set_brightness(uint8_t brightness);
+
+bool palfx_is_fading();
+uint8_t palfx_brightness();
+
+/**
+ * @brief Step all cycles and fades by one frame. Call exactly once per frame.
+ *        All palette changes for the frame are made here, and only when a color actually changes,
+ *        so neslib does at most one palette upload in the following NMI.
+ */
+void palfx_update();
+
+/**
+ * @brief Fade to black and wait for it to finish. Meant for screen transitions, where we are about
+ *        to turn the PPU off anyway.
+ */
+void palfx_fade_out_and_wait();
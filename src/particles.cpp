@@ -0,0 +1,139 @@
+#include "particles.hpp"
+
+#include <cstdint>
+#include <neslib.h>
+
+#include "metasprite.hpp"
+
+constexpr uint8_t SCREEN_HEIGHT = 240;
+
+// The 8 directions a burst can use, starting at right and going clockwise.
+static constexpr int8_t direction_x[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static constexpr int8_t direction_y[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+// A lifetime of 0 marks an unused slot.
+static uint8_t part_x[MAX_PARTICLES];
+static uint8_t part_y[MAX_PARTICLES];
+static int8_t part_vel_x[MAX_PARTICLES];
+static int8_t part_vel_y[MAX_PARTICLES];
+static uint8_t part_life[MAX_PARTICLES];
+static uint8_t part_tile[MAX_PARTICLES];
+static uint8_t part_attr[MAX_PARTICLES];
+
+static uint16_t dropped;
+
+// Velocity along one axis for a direction of -1, 0 or 1, without a multiply.
+static int8_t scale_direction(int8_t direction, int8_t speed)
+{
+    if (direction > 0)
+    {
+        return speed;
+    }
+    if (direction < 0)
+    {
+        return -speed;
+    }
+    return 0;
+}
+
+void particles_clear()
+{
+    for (uint8_t i = 0; i < MAX_PARTICLES; ++i)
+    {
+        part_life[i] = 0;
+    }
+}
+
+void particles_burst(uint8_t x, uint8_t y, Particle_Effects effect)
+{
+    const ParticleEffect& fx = particle_effects[effect];
+
+    // Spread the particles evenly over the 8 directions. Bursts of 4 use the diagonals.
+    uint8_t step = fx.direction_step;
+    uint8_t direction = step >> 1;
+    uint8_t spawned = 0;
+
+    for (uint8_t i = 0; i < MAX_PARTICLES && spawned < fx.count; ++i)
+    {
+        if (part_life[i] != 0)
+        {
+            continue;
+        }
+        part_x[i] = x;
+        part_y[i] = y;
+        part_vel_x[i] = scale_direction(direction_x[direction], fx.speed);
+        part_vel_y[i] = scale_direction(direction_y[direction], fx.speed);
+        part_life[i] = fx.lifetime;
+        part_tile[i] = fx.tile;
+        part_attr[i] = fx.palette;
+
+        direction = (direction + step) & 7;
+        ++spawned;
+    }
+
+    // The pool is full, the rest of the burst is dropped.
+    dropped += fx.count - spawned;
+}
+
+void particles_update(uint8_t budget)
+{
+    uint8_t free_sprites = oam_free_sprites();
+    if (budget > free_sprites)
+    {
+        budget = free_sprites;
+    }
+
+    for (uint8_t i = 0; i < MAX_PARTICLES; ++i)
+    {
+        uint8_t life = part_life[i];
+        if (life == 0)
+        {
+            continue;
+        }
+
+        if (budget == 0)
+        {
+            part_life[i] = 0;
+            ++dropped;
+            continue;
+        }
+        --budget;
+
+        part_life[i] = --life;
+        if (life == 0)
+        {
+            continue;
+        }
+
+        uint8_t x = part_x[i];
+        uint8_t y = part_y[i];
+        int8_t vel_x = part_vel_x[i];
+        uint8_t new_x = x + vel_x;
+        uint8_t new_y = y + part_vel_y[i];
+
+        // Off the left or right edge shows up as the 8 bit add wrapping around.
+        bool wrapped_x = (vel_x > 0) ? (new_x < x) : (new_x > x);
+        if (wrapped_x || new_y >= SCREEN_HEIGHT)
+        {
+            part_life[i] = 0;
+            continue;
+        }
+        part_x[i] = new_x;
+        part_y[i] = new_y;
+
+        if (life >= PARTICLE_FLICKER_FRAMES || (life & 1))
+        {
+            oam_spr(new_x, new_y, part_tile[i], part_attr[i]);
+        }
+    }
+}
+
+uint16_t particles_dropped()
+{
+    return dropped;
+}
+
+void particles_reset_stats()
+{
+    dropped = 0;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Short lived single sprite effects (hit sparks, pickup flashes).
+ *
+ *        Particles are purely cosmetic, so they're the first thing to go when the frame is busy:
+ *        they only use the OAM slots that are still free after everything else has been drawn, and
+ *        `particles_update` never handles more than its budget. Anything over either limit is dropped
+ *        instead of being carried over, so a busy frame can't pile up work for the next one.
+ */
+constexpr uint8_t MAX_PARTICLES = 16;
+
+/**
+ * @brief Default number of particles `particles_update` moves and draws per frame. Every particle costs the
+ *        same fixed number of cycles (no multiplies or 16 bit math), so this is a hard cap on the CPU time.
+ */
+constexpr uint8_t PARTICLE_BUDGET = 12;
+
+/**
+ * @brief Particles flicker for this many frames at the end of their life, as a cheap fade out.
+ */
+constexpr uint8_t PARTICLE_FLICKER_FRAMES = 8;
+
+enum Particle_Effects : uint8_t
+{
+    PARTICLE_EFFECT_HIT_SPARK = 0,
+    PARTICLE_EFFECT_PICKUP_FLASH,
+    PARTICLE_EFFECT_COUNT,
+};
+
+/**
+ * @brief How one burst of particles looks. Each particle of the burst flies out in a different one
+ *        of 8 directions (starting at right, going clockwise) at `speed` pixels per frame.
+ */
+struct ParticleEffect
+{
+    uint8_t count;
+    // How many of the 8 directions to skip between particles, count * direction_step has to be 8.
+    uint8_t direction_step;
+    int8_t speed;
+    uint8_t lifetime;
+    uint8_t tile;
+    uint8_t palette;
+};
+
+constexpr ParticleEffect particle_effects[PARTICLE_EFFECT_COUNT] =
+{
+    // PARTICLE_EFFECT_HIT_SPARK - checkerboard bits flying out diagonally
+    {
+        .count = 4,
+        .direction_step = 2,
+        .speed = 2,
+        .lifetime = 16,
+        .tile = 0x06,
+        .palette = 2,
+    },
+    // PARTICLE_EFFECT_PICKUP_FLASH - slow solid blocks in every direction
+    {
+        .count = 8,
+        .direction_step = 1,
+        .speed = 1,
+        .lifetime = 12,
+        .tile = 0x04,
+        .palette = 3,
+    },
+};
+
+consteval bool particle_effects_cover_all_directions()
+{
+    for (const ParticleEffect& fx : particle_effects)
+    {
+        if (fx.count * fx.direction_step != 8)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(particle_effects_cover_all_directions(), "A burst has to go round all 8 directions once");
+
+/**
+ * @brief Remove every particle.
+ */
+void particles_clear();
+
+/**
+ * @brief Spawn a burst of particles around a screen position. Particles that don't fit in the pool are dropped.
+ */
+void particles_burst(uint8_t x, uint8_t y, Particle_Effects effect);
+
+/**
+ * @brief Move, age and draw the particles. Call once per frame, after all of the other sprites have been drawn.
+ *
+ * @param budget - max number of particles to process this frame, the rest are dropped
+ */
+void particles_update(uint8_t budget = PARTICLE_BUDGET);
+
+/**
+ * @brief Particles dropped because of the budget, the OAM limit, or a full pool since the last reset.
+ */
+uint16_t particles_dropped();
+void particles_reset_stats();
@@ -0,0 +1,144 @@
+#include "popup.hpp"
+
+#include <cstdint>
+#include <neslib.h>
+
+#include "metasprite.hpp"
+#include "metatile.hpp"
+#include "text_pool.hpp"
+
+// A lifetime of 0 marks an unused slot.
+static uint8_t popup_x[MAX_POPUPS];
+static uint8_t popup_y[MAX_POPUPS];
+static uint8_t popup_life[MAX_POPUPS];
+static Popup_Styles popup_style[MAX_POPUPS];
+static uint8_t popup_length[MAX_POPUPS];
+static Letter popup_letters[MAX_POPUPS][POPUP_MAX_LETTERS];
+
+// Flips every frame, longer popups are drawn back to front when it's set.
+static bool reverse_phase;
+
+void popups_clear()
+{
+    for (uint8_t i = 0; i < MAX_POPUPS; ++i)
+    {
+        popup_life[i] = 0;
+    }
+}
+
+void popup_show(uint8_t x, uint8_t y, Text text, Popup_Styles style)
+{
+    // A free slot, or the one closest to the end of its life.
+    uint8_t slot = 0;
+    for (uint8_t i = 1; i < MAX_POPUPS; ++i)
+    {
+        if (popup_life[i] < popup_life[slot])
+        {
+            slot = i;
+        }
+    }
+
+    // Unpack the text once here, instead of every frame while it's drawn.
+    TextReader reader(text);
+    uint8_t length = 0;
+    Letter letter;
+    while (length < POPUP_MAX_LETTERS && reader.next(letter))
+    {
+        popup_letters[slot][length++] = letter;
+    }
+
+    popup_x[slot] = x;
+    popup_y[slot] = y;
+    popup_style[slot] = style;
+    popup_length[slot] = length;
+    popup_life[slot] = popup_styles[style].lifetime;
+}
+
+// Draw the tiles of one letter that aren't blank. Returns the budget that's left.
+static uint8_t draw_letter_sprites(uint8_t x, uint8_t y, Letter letter, uint8_t attr, uint8_t budget)
+{
+    const Metatile_2_3 glyph = letter_glyph(letter);
+    const uint8_t rows[3] = { glyph.top_top, glyph.top_bot, glyph.bot_top };
+    for (uint8_t row = 0; row < 3; ++row)
+    {
+        uint8_t left = LEFT_TILE(rows[row]);
+        uint8_t right = RIGHT_TILE(rows[row]);
+        if (left != 0 && budget != 0)
+        {
+            oam_spr(x, y, left, attr);
+            --budget;
+        }
+        // Don't wrap around to the left edge of the screen.
+        if (right != 0 && budget != 0 && x < 248)
+        {
+            oam_spr(x + 8, y, right, attr);
+            --budget;
+        }
+        y += 8;
+    }
+    return budget;
+}
+
+void popups_update(uint8_t budget)
+{
+    uint8_t free_sprites = oam_free_sprites();
+    if (budget > free_sprites)
+    {
+        budget = free_sprites;
+    }
+
+    reverse_phase = !reverse_phase;
+
+    for (uint8_t i = 0; i < MAX_POPUPS; ++i)
+    {
+        uint8_t life = popup_life[i];
+        if (life == 0)
+        {
+            continue;
+        }
+        popup_life[i] = --life;
+        if (life == 0)
+        {
+            continue;
+        }
+
+        const PopupStyle& style = popup_styles[popup_style[i]];
+        if (style.rise != 0 && (life & style.rise_mask) == 0)
+        {
+            // Gone once it floats off the top.
+            if (popup_y[i] < style.rise)
+            {
+                popup_life[i] = 0;
+                continue;
+            }
+            popup_y[i] -= style.rise;
+        }
+
+        if (life < POPUP_BLINK_FRAMES && (life & 2))
+        {
+            continue;
+        }
+
+        // Letter positions, spaces only take half a letter like on the background.
+        uint8_t length = popup_length[i];
+        uint8_t letter_x[POPUP_MAX_LETTERS];
+        uint8_t x = popup_x[i];
+        for (uint8_t l = 0; l < length; ++l)
+        {
+            letter_x[l] = x;
+            x += (HALF_SIZE_SPACE && popup_letters[i][l] == Letter::SPACE) ? 8 : 16;
+        }
+
+        bool reverse = reverse_phase && length > 4;
+        for (uint8_t n = 0; n < length && budget != 0; ++n)
+        {
+            uint8_t l = reverse ? length - 1 - n : n;
+            // Cut off at the right edge of the screen.
+            if (letter_x[l] < popup_x[i])
+            {
+                continue;
+            }
+            budget = draw_letter_sprites(letter_x[l], popup_y[i], popup_letters[i][l], style.palette, budget);
+        }
+    }
+}
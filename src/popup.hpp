@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+#include "text_render.hpp"
+
+/**
+ * @brief Short lived text drawn with sprites ("+1" on a kill, "RELOAD" when the ammo runs out).
+ *
+ *        The letters are the same 2x3 glyphs as the background font, but each tile is a sprite, so showing and
+ *        removing a popup never touches the nametable or VRAM_BUF. Blank tiles are skipped, so a letter is at most
+ *        6 sprites. The cost is all in OAM, which is bounded per frame: popups only use the sprites still free when
+ *        `popups_update` runs, and never more than their budget.
+ *
+ *        Only 8 sprites show on a scanline, which is 4 letters. Longer popups are drawn in the opposite order every
+ *        other frame, so the letters past the limit flicker instead of always being the ones that go missing.
+ */
+constexpr uint8_t MAX_POPUPS = 2;
+
+/**
+ * @brief Longest popup text, anything longer is cut off.
+ */
+constexpr uint8_t POPUP_MAX_LETTERS = 6;
+
+/**
+ * @brief Default number of sprites `popups_update` draws per frame.
+ */
+constexpr uint8_t POPUP_SPRITE_BUDGET = 24;
+
+/**
+ * @brief Popups blink for this many frames at the end of their life.
+ */
+constexpr uint8_t POPUP_BLINK_FRAMES = 16;
+
+enum Popup_Styles : uint8_t
+{
+    POPUP_STYLE_SCORE = 0,
+    POPUP_STYLE_WARNING,
+    POPUP_STYLE_COUNT,
+};
+
+/**
+ * @brief How a popup moves and how long it stays. It moves `rise` pixels up on the frames where
+ *        `lifetime & rise_mask` is 0, so a mask of 1 is every other frame.
+ */
+struct PopupStyle
+{
+    uint8_t lifetime;
+    uint8_t rise;
+    uint8_t rise_mask;
+    uint8_t palette;
+};
+
+constexpr PopupStyle popup_styles[POPUP_STYLE_COUNT] =
+{
+    // POPUP_STYLE_SCORE - floats up off the enemy that was shot
+    {
+        .lifetime = 40,
+        .rise = 1,
+        .rise_mask = 1,
+        .palette = 1,
+    },
+    // POPUP_STYLE_WARNING - stays put and blinks out
+    {
+        .lifetime = 90,
+        .rise = 0,
+        .rise_mask = 0,
+        .palette = 3,
+    },
+};
+
+/**
+ * @brief Remove every popup.
+ */
+void popups_clear();
+
+/**
+ * @brief Show a popup with its top left corner at a screen position. If all slots are in use, the oldest
+ *        popup is replaced.
+ */
+void popup_show(uint8_t x, uint8_t y, Text text, Popup_Styles style);
+
+/**
+ * @brief Move, age and draw the popups. Call once per frame, after the sprites that matter more.
+ *
+ * @param budget - max number of sprites to draw this frame
+ */
+void popups_update(uint8_t budget = POPUP_SPRITE_BUDGET);
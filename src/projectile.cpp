@@ -0,0 +1,124 @@
+#include "projectile.hpp"
+
+#include <cstdint>
+#include <neslib.h>
+
+// A y position past the bottom of the screen marks an unused slot, no separate flag needed.
+// OAM treats the same values as hidden, so this also reads naturally when drawing.
+constexpr uint8_t UNUSED_Y = 0xff;
+constexpr uint8_t SCREEN_HEIGHT = 240;
+
+static uint8_t proj_x[MAX_PROJECTILES];
+// projectiles_clear() runs at boot to mark every slot unused.
+static uint8_t proj_y[MAX_PROJECTILES];
+static int8_t proj_vel_x[MAX_PROJECTILES];
+static int8_t proj_vel_y[MAX_PROJECTILES];
+
+// Next slot to hand out. Always the oldest projectile (or a free slot).
+static uint8_t ring_head;
+static uint8_t active_count;
+
+void projectiles_clear()
+{
+    for (uint8_t i = 0; i < MAX_PROJECTILES; ++i)
+    {
+        proj_y[i] = UNUSED_Y;
+    }
+    ring_head = 0;
+    active_count = 0;
+}
+
+void projectile_spawn(uint8_t x, uint8_t y, int8_t vel_x, int8_t vel_y)
+{
+    uint8_t i = ring_head;
+    ring_head = (ring_head + 1) & (MAX_PROJECTILES - 1);
+
+    if (proj_y[i] == UNUSED_Y)
+    {
+        ++active_count;
+    }
+    proj_x[i] = x;
+    proj_y[i] = y;
+    proj_vel_x[i] = vel_x;
+    proj_vel_y[i] = vel_y;
+}
+
+void projectiles_update(int8_t scroll_dx)
+{
+    // Nothing to move, don't walk the pool.
+    if (active_count == 0)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < MAX_PROJECTILES; ++i)
+    {
+        uint8_t y = proj_y[i];
+        if (y == UNUSED_Y)
+        {
+            continue;
+        }
+
+        // Moving the other way to the camera keeps the projectile still in the world.
+        int8_t dx = proj_vel_x[i] - scroll_dx;
+        uint8_t x = proj_x[i];
+        uint8_t new_x = x + dx;
+        uint8_t new_y = y + proj_vel_y[i];
+
+        // Off the left or right edge shows up as the 8 bit add wrapping around,
+        // off the top or bottom as a y past the bottom of the screen.
+        bool wrapped_x = (dx > 0) ? (new_x < x) : (new_x > x);
+        if (wrapped_x || new_y >= SCREEN_HEIGHT)
+        {
+            proj_y[i] = UNUSED_Y;
+            --active_count;
+            continue;
+        }
+
+        proj_x[i] = new_x;
+        proj_y[i] = new_y;
+    }
+}
+
+bool projectiles_hit(uint8_t x, uint8_t y, uint8_t w, uint8_t h)
+{
+    bool hit = false;
+    if (active_count == 0)
+    {
+        return hit;
+    }
+
+    for (uint8_t i = 0; i < MAX_PROJECTILES; ++i)
+    {
+        // Unsigned wrap around turns each range check into a single compare. Unused slots
+        // can't pass the y check as long as the rectangle is on screen.
+        if ((uint8_t)(proj_x[i] - x) < w && (uint8_t)(proj_y[i] - y) < h && proj_y[i] != UNUSED_Y)
+        {
+            proj_y[i] = UNUSED_Y;
+            --active_count;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+void projectiles_draw()
+{
+    if (active_count == 0)
+    {
+        return;
+    }
+
+    for (uint8_t i = 0; i < MAX_PROJECTILES; ++i)
+    {
+        if (proj_y[i] != UNUSED_Y)
+        {
+            oam_spr(proj_x[i], proj_y[i], PROJECTILE_TILE, PROJECTILE_PALETTE);
+        }
+    }
+}
+
+uint8_t projectiles_active()
+{
+    return active_count;
+}
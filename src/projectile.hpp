@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Pool of simple projectiles, kept separate from `ActiveEntities` so bullets don't compete with
+ *        enemies and pickups for the entity slots.
+ *
+ *        Everything is stored as structure of arrays with 8 bit screen positions and whole pixel velocities,
+ *        so moving, culling and drawing the whole pool is a handful of 8 bit ops per projectile.
+ *        Slots are handed out from a ring: spawning is O(1) and, when the pool is full, replaces the oldest
+ *        projectile instead of searching for a free slot.
+ */
+constexpr uint8_t MAX_PROJECTILES = 32;
+static_assert((MAX_PROJECTILES & (MAX_PROJECTILES - 1)) == 0, "MAX_PROJECTILES must be a power of 2");
+
+// Projectiles are drawn as a single 4x4 block (the top left quadrant tile of the Game Genie CHR).
+constexpr uint8_t PROJECTILE_TILE = 0x04;
+constexpr uint8_t PROJECTILE_SIZE = 4;
+constexpr uint8_t PROJECTILE_PALETTE = 1;
+
+/**
+ * @brief Remove every projectile. Must run once at boot, before the pool is used.
+ */
+void projectiles_clear();
+
+/**
+ * @brief Fire a projectile from a screen position with a velocity in pixels per frame.
+ */
+void projectile_spawn(uint8_t x, uint8_t y, int8_t vel_x, int8_t vel_y);
+
+/**
+ * @brief Move every projectile and remove the ones that left the screen. Call once per frame.
+ *
+ * @param scroll_dx - how far the camera moved this frame. Positions are in screen space,
+ *                    so this keeps projectiles in place in the world while scrolling.
+ */
+void projectiles_update(int8_t scroll_dx = 0);
+
+/**
+ * @brief Remove every projectile whose top left corner is inside the rectangle.
+ *
+ * @return true if any projectile was hit
+ */
+bool projectiles_hit(uint8_t x, uint8_t y, uint8_t w, uint8_t h);
+
+/**
+ * @brief Add a sprite for every projectile to OAM.
+ */
+void projectiles_draw();
+
+uint8_t projectiles_active();
@@ -0,0 +1,153 @@
+#include "screen.hpp"
+
+#if NT_DOUBLE_BUFFER
+
+#include <cstdint>
+#include <nesdoug.h>
+#include <neslib.h>
+
+// Include the VRAM buffer and the VRAM_INDEX so we can write directly into the buffer ourselves.
+extern volatile uint8_t VRAM_BUF[128];
+extern volatile __zeropage uint8_t VRAM_INDEX;
+extern volatile __zeropage uint8_t NAME_UPD_ENABLE;
+
+// The nametable plus its attributes
+static constexpr uint16_t NAMETABLE_SIZE = 1024;
+
+static Nametable front = Nametable::A;
+
+// The screen in (or going into) the back buffer, nullptr if there isn't one.
+static const unsigned char* prepare_rle;
+// Where the decoder is in the RLE data. Same format as vram_unrle: a tag byte, then bytes, where `tag, n`
+// repeats the last byte n more times and `tag, 0` is the end.
+static const unsigned char* prepare_src;
+static uint8_t prepare_tag;
+static uint8_t prepare_last;
+// Copies of prepare_last still to write
+static uint8_t prepare_repeat;
+static uint16_t prepare_written;
+static bool prepare_done;
+
+static Nametable back()
+{
+    return (front == Nametable::A) ? Nametable::B : Nametable::A;
+}
+
+static uint16_t nametable_address(Nametable nmt)
+{
+    return 0x2000 | (((uint8_t)nmt) << 8);
+}
+
+// Nametable B is to the right of A (vertical mirroring), so showing it is scrolling over by a screen.
+static void scroll_to_front()
+{
+    scroll(front == Nametable::B ? 256 : 0, 0);
+}
+
+Nametable screen_nmt()
+{
+    return front;
+}
+
+uint8_t screen_index()
+{
+    return ((uint8_t)front) >> 2;
+}
+
+bool screen_is_prepared(const unsigned char* rle)
+{
+    return prepare_done && prepare_rle == rle;
+}
+
+void screen_show(const unsigned char* rle)
+{
+    if (screen_is_prepared(rle))
+    {
+        // Takes effect on the next NMI, after the last of the screen has been uploaded.
+        front = back();
+        scroll_to_front();
+        prepare_rle = nullptr;
+        return;
+    }
+
+    ppu_off();
+    scroll_to_front();
+    vram_adr(nametable_address(front));
+    vram_unrle(rle);
+}
+
+void screen_prepare(const unsigned char* rle)
+{
+    if (prepare_rle == rle)
+    {
+        return;
+    }
+    prepare_rle = rle;
+    prepare_tag = rle[0];
+    prepare_src = rle + 1;
+    prepare_repeat = 0;
+    prepare_written = 0;
+    prepare_done = false;
+}
+
+void screen_prepare_step()
+{
+    if (prepare_rle == nullptr || prepare_done)
+    {
+        return;
+    }
+
+    // Room for the run header, the bytes and the end marker. If the buffer's busy, try again next frame.
+    uint8_t idx = VRAM_INDEX;
+    if (idx > 127 - 3 - SCREEN_PREPARE_BYTES)
+    {
+        return;
+    }
+
+    uint8_t count = 0;
+    uint8_t at = idx + 3;
+    while (count < SCREEN_PREPARE_BYTES && prepare_written + count < NAMETABLE_SIZE)
+    {
+        if (prepare_repeat == 0)
+        {
+            uint8_t b = prepare_src[0];
+            if (b != prepare_tag)
+            {
+                prepare_last = b;
+                prepare_repeat = 1;
+                ++prepare_src;
+            }
+            else if (prepare_src[1] == 0)
+            {
+                break;
+            }
+            else
+            {
+                prepare_repeat = prepare_src[1];
+                prepare_src += 2;
+            }
+        }
+        VRAM_BUF[at++] = prepare_last;
+        --prepare_repeat;
+        ++count;
+    }
+
+    if (count != 0)
+    {
+        uint16_t ppuaddr = nametable_address(back()) + prepare_written;
+        VRAM_BUF[idx + 0] = MSB(ppuaddr) | NT_UPD_HORZ;
+        VRAM_BUF[idx + 1] = LSB(ppuaddr);
+        VRAM_BUF[idx + 2] = count;
+        VRAM_BUF[at] = NT_UPD_EOF;
+        VRAM_INDEX = at;
+        NAME_UPD_ENABLE = true;
+        prepare_written += count;
+    }
+
+    if (count < SCREEN_PREPARE_BYTES || prepare_written == NAMETABLE_SIZE)
+    {
+        prepare_done = true;
+    }
+}
+
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <neslib.h>
+
+#include "metatile.hpp"
+
+/**
+ * @brief Which nametable the current screen is in, and switching screens (NT_DOUBLE_BUFFER, set from CMakeLists.txt).
+ *
+ *        Without NT_DOUBLE_BUFFER every screen is decoded straight into nametable A with rendering off, so a state
+ *        change is a fade out, a few blank frames, and a fade in.
+ *
+ *        With it, nametable B is a back buffer. After each state change the screen of the state that usually
+ *        comes next is decoded into the hidden nametable a little at a time, as one VRAM_BUF run on each frame that
+ *        isn't shedding work (see lag.hpp). When that state is entered the screen is already there, and the switch
+ *        is just the base nametable bits in PPU_CTRL, with rendering left on. If it isn't ready yet (or a different
+ *        state comes next), the screen is decoded in place the old way.
+ *
+ *        Everything that draws to the current screen has to use `screen_nmt` / `screen_index` instead of
+ *        nametable A. NT_DOUBLE_BUFFER can't be used with ARENA_SCROLL, which needs both nametables for the arena.
+ */
+
+/**
+ * @brief Nametable bytes decoded into the back buffer per frame, about 520 cycles of vblank.
+ */
+constexpr uint8_t SCREEN_PREPARE_BYTES = 32;
+
+#if NT_DOUBLE_BUFFER
+
+/**
+ * @brief The nametable that's on screen.
+ */
+Nametable screen_nmt();
+
+/**
+ * @brief Same, as the nametable number `get_ppu_addr` takes.
+ */
+uint8_t screen_index();
+
+/**
+ * @brief Show an NESLIB RLE screen. Instant if it's been prepared in the back buffer, otherwise rendering is turned
+ *        off and it's decoded into the current nametable (turn rendering back on once the rest is drawn).
+ */
+void screen_show(const unsigned char* rle);
+
+/**
+ * @brief Is this screen fully decoded in the back buffer, so `screen_show` would be instant?
+ */
+bool screen_is_prepared(const unsigned char* rle);
+
+/**
+ * @brief Start decoding a screen into the back buffer. Does nothing if it's already that screen.
+ */
+void screen_prepare(const unsigned char* rle);
+
+/**
+ * @brief Decode the next part of the screen being prepared. Call once a frame, while rendering is on.
+ */
+void screen_prepare_step();
+
+#else
+
+inline Nametable screen_nmt()
+{
+    return Nametable::A;
+}
+
+inline uint8_t screen_index()
+{
+    return 0;
+}
+
+inline void screen_show(const unsigned char* rle)
+{
+    ppu_off();
+    scroll(0, 0);
+    vram_adr(NAMETABLE_A);
+    vram_unrle(rle);
+}
+
+inline bool screen_is_prepared(const unsigned char*)
+{
+    return false;
+}
+
+inline void screen_prepare(const unsigned char*) {}
+inline void screen_prepare_step() {}
+
+#endif
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "metatile.hpp"
+#include "text_pool.hpp"
+#include "text_render.hpp"
+
+/**
+ * @brief Static text and tiles composited into a screen's NESLIB RLE data at compile time.
+ *
+ *        Anything a state draws on every entry that never changes (labels, the starting ammo icons) can be listed
+ *        as stamps instead, and `bake_screen` decodes the screen, draws the stamps into it the same way
+ *        `render_string` would, and compresses the result again. Entering the state is then only the one
+ *        `vram_unrle`, and runtime text is left for the values that actually change.
+ *
+ *        The baked data is a new array, so the plain screen is still there for the states that use it as is.
+ */
+
+/**
+ * @brief Nametable and attributes
+ */
+constexpr size_t SCREEN_BYTES = 1024;
+
+/**
+ * @brief Largest NESLIB RLE of a screen: the tag, every byte on its own, and the end marker.
+ */
+constexpr size_t SCREEN_MAX_RLE = 1 + SCREEN_BYTES + 2;
+
+constexpr uint8_t SCREEN_COLUMNS = 32;
+constexpr uint8_t SCREEN_ROWS = 30;
+
+/**
+ * @brief The font, for compositing text. The ROM copy is in text_render.cpp.
+ */
+inline constexpr Metatile_2_3 screen_bake_font[Letter::COUNT] =
+{
+    #include "font.inc"
+};
+
+/**
+ * @brief Something to draw into a baked screen. Make them with `screen_text`, `screen_tile` and `screen_tile_run`.
+ */
+struct ScreenStamp
+{
+    uint8_t x;
+    uint8_t y;
+    // nullptr for a run of tiles
+    const char* text;
+    uint8_t tile;
+    // How many times the tile repeats to the right
+    uint8_t count;
+};
+
+/**
+ * @brief Text drawn at tile x, y, laid out exactly like `render_string` does (spaces are skipped, and only a tile wide).
+ */
+consteval ScreenStamp screen_text(uint8_t x, uint8_t y, const char* text)
+{
+    return ScreenStamp{ x, y, text, 0, 0 };
+}
+
+/**
+ * @brief A single tile at tile x, y.
+ */
+consteval ScreenStamp screen_tile(uint8_t x, uint8_t y, uint8_t tile)
+{
+    return ScreenStamp{ x, y, nullptr, tile, 1 };
+}
+
+/**
+ * @brief `count` of the same tile in a row, starting at tile x, y and going right.
+ */
+consteval ScreenStamp screen_tile_run(uint8_t x, uint8_t y, uint8_t tile, uint8_t count)
+{
+    return ScreenStamp{ x, y, nullptr, tile, count };
+}
+
+/**
+ * @brief The screen as it's being composited, with room for the largest compressed one.
+ */
+struct ScreenBuilder
+{
+    uint8_t bytes[SCREEN_BYTES]{};
+    uint8_t rle[SCREEN_MAX_RLE]{};
+    size_t size = 0;
+
+    consteval void put(uint8_t x, uint8_t y, uint8_t tile)
+    {
+        if (x >= SCREEN_COLUMNS || y >= SCREEN_ROWS)
+        {
+            throw "A stamp is off the screen";
+        }
+        bytes[y * SCREEN_COLUMNS + x] = tile;
+    }
+
+    // Same as vram_unrle: a tag byte, then bytes, where `tag, n` repeats the last byte n more times and `tag, 0` ends it.
+    consteval void decode(const uint8_t* src)
+    {
+        uint8_t tag = *src++;
+        uint8_t last = 0;
+        size_t at = 0;
+        while (true)
+        {
+            uint8_t b = *src++;
+            size_t repeat = 1;
+            if (b == tag)
+            {
+                repeat = *src++;
+                if (repeat == 0)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                last = b;
+            }
+            for (size_t i = 0; i < repeat; ++i)
+            {
+                if (at == SCREEN_BYTES)
+                {
+                    throw "The screen decodes to more than a nametable";
+                }
+                bytes[at++] = last;
+            }
+        }
+        if (at != SCREEN_BYTES)
+        {
+            throw "The screen decodes to less than a nametable";
+        }
+    }
+
+    // The letter layout of put_letter in text_render.cpp
+    consteval void draw_text(uint8_t x, uint8_t y, const char* text)
+    {
+        for (const char* c = text; *c != '\0'; ++c)
+        {
+            Letter letter = text_letter(*c);
+            if (!SKIP_DRAWING_SPACE || letter != Letter::SPACE)
+            {
+                const Metatile_2_3& glyph = screen_bake_font[letter];
+                const uint8_t rows[] = { glyph.top_top, glyph.top_bot, glyph.bot_top };
+                for (uint8_t row = 0; row < 3; ++row)
+                {
+                    put(x, y + row, LEFT_TILE(rows[row]));
+                    put(x + 1, y + row, RIGHT_TILE(rows[row]));
+                }
+            }
+            x += (HALF_SIZE_SPACE && letter == Letter::SPACE) ? 1 : 2;
+            if (x >= 31)
+            {
+                x = 0;
+                y += 3;
+            }
+        }
+    }
+
+    // The same encoder as cmake/nss-convert.cmake, so a screen without stamps comes out byte for byte the same.
+    consteval void encode()
+    {
+        // The tag is the least used byte value (the lowest one on a tie).
+        size_t used[256]{};
+        for (size_t i = 0; i < SCREEN_BYTES; ++i)
+        {
+            ++used[bytes[i]];
+        }
+        uint8_t tag = 0;
+        for (size_t b = 0; b < 256; ++b)
+        {
+            if (used[b] < used[tag])
+            {
+                tag = (uint8_t)b;
+            }
+        }
+        if (used[tag] != 0)
+        {
+            throw "Every byte value is used, there's nothing left for the RLE tag";
+        }
+
+        rle[size++] = tag;
+        for (size_t i = 0; i < SCREEN_BYTES;)
+        {
+            size_t run = 1;
+            while (i + run < SCREEN_BYTES && run < 255 && bytes[i + run] == bytes[i])
+            {
+                ++run;
+            }
+            rle[size++] = bytes[i];
+            if (run == 2)
+            {
+                rle[size++] = bytes[i];
+            }
+            else if (run > 2)
+            {
+                rle[size++] = tag;
+                rle[size++] = (uint8_t)(run - 1);
+            }
+            i += run;
+        }
+        rle[size++] = tag;
+        rle[size++] = 0;
+    }
+
+    consteval ScreenBuilder(const uint8_t* base, const ScreenStamp* stamps, size_t stamp_count)
+    {
+        decode(base);
+        for (size_t s = 0; s < stamp_count; ++s)
+        {
+            if (stamps[s].text != nullptr)
+            {
+                draw_text(stamps[s].x, stamps[s].y, stamps[s].text);
+            }
+            else
+            {
+                for (uint8_t i = 0; i < stamps[s].count; ++i)
+                {
+                    put(stamps[s].x + i, stamps[s].y, stamps[s].tile);
+                }
+            }
+        }
+        encode();
+    }
+};
+
+template<size_t Size>
+struct BakedScreen
+{
+    uint8_t rle[Size]{};
+};
+
+/**
+ * @brief `Base` (NESLIB RLE) with every stamp in `Stamps` drawn into it, compressed again.
+ *        Use the `rle` member anywhere the plain screen would go.
+ */
+template<const auto& Base, const auto& Stamps>
+consteval auto bake_screen()
+{
+    constexpr ScreenBuilder builder(Base, Stamps, sizeof(Stamps) / sizeof(Stamps[0]));
+    BakedScreen<builder.size> out;
+    for (size_t i = 0; i < builder.size; ++i)
+    {
+        out.rle[i] = builder.rle[i];
+    }
+    return out;
+}
@@ -0,0 +1,140 @@
+#include "split.hpp"
+#include "clock.hpp"
+
+#include <cstdint>
+#include <neslib.h>
+#include <peekpoke.h>
+
+constexpr uint16_t PPU_STATUS_ADDR = 0x2002;
+constexpr uint16_t PPU_SCROLL_ADDR = 0x2005;
+constexpr uint16_t PPU_ADDR_ADDR = 0x2006;
+constexpr uint8_t PPU_STATUS_SPRITE0_HIT = 0x40;
+
+// Scanlines in vblank plus the pre-render line, per region. The wait can start anywhere from the top of vblank.
+static constexpr uint8_t vblank_lines[CLOCK_REGION_COUNT] = { 21, 71 };
+// CPU cycles per scanline, rounded down.
+static constexpr uint8_t cycles_per_line[CLOCK_REGION_COUNT] = { 113, 106 };
+
+static bool enabled = false;
+static uint8_t split_line;
+static uint16_t split_x;
+static uint16_t timeout;
+
+static uint16_t last_wait;
+static uint16_t worst_wait;
+static uint16_t timeouts;
+
+void split_enable(uint8_t line)
+{
+    enabled = true;
+    split_line = line;
+    // Allow for the worst case of starting the wait at the very top of vblank, plus a few lines of slack.
+    // PAL has more than 3 times the vblank of NTSC, so this needs the region from clock_init().
+    Clock_Region region = clock_region();
+    timeout = (uint16_t)(vblank_lines[region] + line + 8) * cycles_per_line[region] / SPLIT_CYCLES_PER_ITERATION;
+}
+
+void split_disable()
+{
+    enabled = false;
+}
+
+bool split_is_enabled()
+{
+    return enabled;
+}
+
+void split_set_scroll(uint16_t x)
+{
+    split_x = x;
+}
+
+void split_place_sprite0()
+{
+    if (!enabled)
+    {
+        return;
+    }
+    // Sprites are drawn one line below their y value. Priority behind the background hides it
+    // behind the opaque pixel it's using for the hit.
+    oam_spr(SPLIT_SPRITE_X, split_line - 1, SPLIT_SPRITE_TILE, 0x20);
+}
+
+bool split_wait()
+{
+    if (!enabled)
+    {
+        return true;
+    }
+
+#if SPLIT_PROFILE
+    // Start marker for split-wait-mesen2.lua. $401D is unmapped on the NES, so this write is harmless.
+    POKE(0x401D, 1);
+#endif
+
+    uint16_t iterations = 0;
+    bool hit = false;
+
+    // The flag from last frame stays set until the end of vblank, wait for that first.
+    while ((PEEK(PPU_STATUS_ADDR) & PPU_STATUS_SPRITE0_HIT) && iterations < timeout)
+    {
+        ++iterations;
+    }
+    while (iterations < timeout)
+    {
+        if (PEEK(PPU_STATUS_ADDR) & PPU_STATUS_SPRITE0_HIT)
+        {
+            hit = true;
+            break;
+        }
+        ++iterations;
+    }
+
+    // Set the whole scroll position through $2006 so the nametable can change mid-frame without touching
+    // PPU_CTRL. Y has to be the line that's about to be drawn, or the rest of the screen jumps up or down.
+    // The status reads above already reset the $2005/$2006 write latch.
+    uint8_t y = split_line + 1;
+    uint8_t x = (uint8_t)split_x;
+    POKE(PPU_ADDR_ADDR, (split_x & 0x100) ? 0x04 : 0x00);
+    POKE(PPU_SCROLL_ADDR, y);
+    POKE(PPU_SCROLL_ADDR, x);
+    POKE(PPU_ADDR_ADDR, ((y & 0xf8) << 2) | (x >> 3));
+
+#if SPLIT_PROFILE
+    // End marker
+    POKE(0x401D, 0);
+#endif
+
+    last_wait = iterations;
+    if (iterations > worst_wait)
+    {
+        worst_wait = iterations;
+    }
+    if (!hit)
+    {
+        ++timeouts;
+    }
+    return hit;
+}
+
+uint16_t split_last_wait()
+{
+    return last_wait;
+}
+
+uint16_t split_worst_wait()
+{
+    return worst_wait;
+}
+
+uint16_t split_timeouts()
+{
+    return timeouts;
+}
+
+void split_reset_stats()
+{
+    last_wait = 0;
+    worst_wait = 0;
+    timeouts = 0;
+}
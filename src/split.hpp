@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Sprite zero split. Everything above the split line is drawn with the scroll set in NMI (normally 0, 0
+ *        so the HUD stays still) and everything below it uses the scroll given to `split_set_scroll`.
+ *
+ *        How it works: sprite 0 is placed (behind the background) so its top row lands on the split line, over an
+ *        opaque background pixel. The PPU raises the sprite 0 hit flag when it draws that pixel, and `split_wait`
+ *        busy waits for the flag and then changes the scroll for the rest of the frame.
+ *
+ *        The time spent busy waiting is wasted, so it's measured. Any work that always finishes before the split
+ *        line is reached can be moved in front of `split_wait` for free. Run Mesen with `split-wait-mesen2.lua` on a
+ *        build configured with -DSPLIT_PROFILE=On for exact cycle counts.
+ */
+
+/**
+ * @brief Sprite 0 is drawn with this tile, at this x position. There must be an opaque background pixel
+ *        under it on the split line. Sprite 0 hits are never reported at x = 255, so stay left of that.
+ */
+constexpr uint8_t SPLIT_SPRITE_TILE = 0x0f;
+constexpr uint8_t SPLIT_SPRITE_X = 248;
+
+/**
+ * @brief Rough cost of one iteration of the wait loop, used to turn iteration counts into cycles.
+ *        The exact cost depends on the compiler output, measure with SPLIT_PROFILE if it matters.
+ */
+constexpr uint8_t SPLIT_CYCLES_PER_ITERATION = 16;
+
+/**
+ * @brief Turn the split on. Sprite 0 is placed on `line`, and the new scroll takes effect from the line after it.
+ *        The wait timeout depends on the region, so call this after `clock_init`.
+ */
+void split_enable(uint8_t line);
+void split_disable();
+bool split_is_enabled();
+
+/**
+ * @brief Scroll to use below the split line from the next frame on.
+ */
+void split_set_scroll(uint16_t x);
+
+/**
+ * @brief Put sprite 0 on the split line. It has to be the first sprite drawn each frame,
+ *        so call this right after `oam_clear`. Does nothing when the split is disabled.
+ */
+void split_place_sprite0();
+
+/**
+ * @brief Wait for the sprite 0 hit and apply the scroll. Call once per frame after NMI, before the split line
+ *        is reached. Gives up if the hit doesn't happen in time (for instance when sprites or the background
+ *        were turned off for the zapper), so a missing sprite 0 costs at most part of a frame instead of hanging.
+ *        Does nothing when the split is disabled.
+ *
+ * @return false if the wait timed out
+ */
+bool split_wait();
+
+/**
+ * @brief Busy wait measurements, in loop iterations (multiply by SPLIT_CYCLES_PER_ITERATION for cycles).
+ *        `split_worst_wait` and `split_timeouts` accumulate until `split_reset_stats`.
+ */
+uint16_t split_last_wait();
+uint16_t split_worst_wait();
+uint16_t split_timeouts();
+void split_reset_stats();
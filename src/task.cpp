@@ -0,0 +1,59 @@
+#include "task.hpp"
+
+#include <cstdint>
+
+static Task tasks[MAX_TASKS];
+
+bool task_start(Task_Fn fn)
+{
+    Task* free_slot = nullptr;
+    for (uint8_t i = 0; i < MAX_TASKS; ++i)
+    {
+        if (tasks[i].fn == fn)
+        {
+            return false;
+        }
+        if (tasks[i].fn == nullptr && free_slot == nullptr)
+        {
+            free_slot = &tasks[i];
+        }
+    }
+    if (free_slot == nullptr)
+    {
+        return false;
+    }
+    free_slot->fn = fn;
+    free_slot->resume = 0;
+    return true;
+}
+
+bool task_running(Task_Fn fn)
+{
+    for (uint8_t i = 0; i < MAX_TASKS; ++i)
+    {
+        if (tasks[i].fn == fn)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void tasks_run()
+{
+    for (uint8_t i = 0; i < MAX_TASKS; ++i)
+    {
+        if (tasks[i].fn != nullptr && tasks[i].fn(tasks[i]) == TASK_DONE)
+        {
+            tasks[i].fn = nullptr;
+        }
+    }
+}
+
+void tasks_clear()
+{
+    for (uint8_t i = 0; i < MAX_TASKS; ++i)
+    {
+        tasks[i].fn = nullptr;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Cooperative tasks for work that takes more than one frame, like the zapper scan or text that doesn't fit
+ *        in this frame's VRAM buffer. Instead of waiting for NMI in a loop (which stops everything else), a task
+ *        yields, and the main loop resumes it once a frame with `tasks_run`, right after NMI. The rest of the game
+ *        keeps running in between.
+ *
+ *        Tasks are stackless: a task is a function that picks up where it left off with a switch on the line it
+ *        yielded from (see TASK_BEGIN). Locals don't survive a yield, so anything a task needs across frames goes in
+ *        static variables, which is how llvm-mos treats non-reentrant functions anyway. The same function can only
+ *        run as one task at a time.
+ *
+ *        Every task is dropped on a state change, so a task should reset its statics when it starts, not when it ends.
+ */
+constexpr uint8_t MAX_TASKS = 4;
+
+enum Task_Status : uint8_t
+{
+    TASK_RUNNING,
+    TASK_DONE,
+};
+
+struct Task;
+typedef Task_Status (*Task_Fn)(Task& task);
+
+struct Task
+{
+    Task_Fn fn;
+    // Line of the TASK_YIELD to resume from, 0 is the start.
+    uint16_t resume;
+};
+
+/**
+ * @brief Start of a task's body, TASK_END goes at the end. There can't be another switch around a TASK_YIELD.
+ */
+#define TASK_BEGIN(task) switch ((task).resume) { case 0:
+
+/**
+ * @brief Stop here until the next frame.
+ */
+#define TASK_YIELD(task) \
+    do { (task).resume = __LINE__; return TASK_RUNNING; case __LINE__:; } while (0)
+
+#define TASK_END(task) } return TASK_DONE
+
+/**
+ * @brief Start running `fn` from the next `tasks_run`.
+ *
+ * @return false if it's already running or every slot is taken
+ */
+bool task_start(Task_Fn fn);
+
+bool task_running(Task_Fn fn);
+
+/**
+ * @brief Resume every task once. Call once a frame, after NMI.
+ */
+void tasks_run();
+
+/**
+ * @brief Drop every task, wherever it is.
+ */
+void tasks_clear();
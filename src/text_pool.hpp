@@ -0,0 +1,396 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "text_render.hpp"
+
+/**
+ * @brief All of the game's text, stored once in a compressed pool that's built at compile time.
+ *
+ *        The strings are listed in text_pool.inc. `"..."_l` looks its string up in the list and gives back a `Text`
+ *        pointing into the pool, so the call sites read the same as before but a literal is never stored on its own.
+ *        Identical strings (ignoring case) share their bytes, and so does a string that's the end of another one.
+ *
+ *        The pool is byte pair encoded: codes below Letter::COUNT are letters, the codes above that up to
+ *        TEXT_END each stand for a pair of other codes, and TEXT_END ends a string. The compressor keeps
+ *        replacing the most common pair in the whole pool with a new code while that saves at least a byte
+ *        over the 2 bytes the pair costs in the dictionary, so common words and runs of spaces end up as a
+ *        single byte. `TextReader` expands the codes one letter at a time, with a stack of TEXT_MAX_DEPTH bytes.
+ *
+ *        Compression is quadratic in the size of the pool. If it ever grows enough to hit the compiler's
+ *        constexpr step limit, raise it with -fconstexpr-steps.
+ */
+
+constexpr uint8_t TEXT_END = 0xff;
+
+/**
+ * @brief How deeply pairs can nest. This is also the size of the decoder's stack.
+ */
+constexpr uint8_t TEXT_MAX_DEPTH = 6;
+
+/**
+ * @brief Space for the pool while it's being compressed, including the TEXT_END of every string.
+ */
+constexpr size_t TEXT_POOL_MAX_CODES = 1024;
+
+constexpr size_t TEXT_MAX_PAIRS = TEXT_END - Letter::COUNT;
+
+inline constexpr const char* text_pool_strings[] =
+{
+    #include "text_pool.inc"
+};
+constexpr size_t TEXT_POOL_STRINGS = sizeof(text_pool_strings) / sizeof(text_pool_strings[0]);
+
+consteval Letter text_letter(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return (Letter)(c - '0' + Letter::_0);
+    }
+    if (c >= 'A' && c <= 'Z')
+    {
+        return (Letter)(c - 'A' + Letter::A);
+    }
+    if (c >= 'a' && c <= 'z')
+    {
+        return (Letter)(c - 'a' + Letter::A);
+    }
+    if (c == '+')
+    {
+        return Letter::PLUS;
+    }
+    return Letter::SPACE;
+}
+
+consteval bool text_equal(const char* a, const char* b)
+{
+    for (;; ++a, ++b)
+    {
+        if (*a == '\0' || *b == '\0')
+        {
+            return *a == *b;
+        }
+        if (text_letter(*a) != text_letter(*b))
+        {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief The pool as it's being compressed, with room for the largest one.
+ */
+struct TextPoolBuilder
+{
+    uint8_t codes[TEXT_POOL_MAX_CODES]{};
+    size_t size = 0;
+    uint8_t pair_left[TEXT_MAX_PAIRS]{};
+    uint8_t pair_right[TEXT_MAX_PAIRS]{};
+    size_t pairs = 0;
+    // Which of the stored strings each entry of text_pool_strings uses
+    uint8_t unique_index[TEXT_POOL_STRINGS]{};
+    size_t unique = 0;
+    // Where each stored string starts
+    size_t offsets[256]{};
+
+    consteval uint8_t depth(uint8_t code) const
+    {
+        if (code < Letter::COUNT)
+        {
+            return 0;
+        }
+        uint8_t left = depth(pair_left[code - Letter::COUNT]);
+        uint8_t right = depth(pair_right[code - Letter::COUNT]);
+        return 1 + (left > right ? left : right);
+    }
+
+    // Occurrences of the pair starting at `at`, without overlaps ("   " is only one "  ").
+    consteval size_t count_pair(size_t at) const
+    {
+        size_t count = 0;
+        for (size_t i = at; i + 1 < size; ++i)
+        {
+            if (codes[i] == codes[at] && codes[i + 1] == codes[at + 1])
+            {
+                ++count;
+                ++i;
+            }
+        }
+        return count;
+    }
+
+    consteval void replace_pair(uint8_t left, uint8_t right, uint8_t code)
+    {
+        size_t out = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (i + 1 < size && codes[i] == left && codes[i + 1] == right)
+            {
+                codes[out++] = code;
+                ++i;
+            }
+            else
+            {
+                codes[out++] = codes[i];
+            }
+        }
+        size = out;
+    }
+
+    // Drop every string whose codes are the end of a longer one ("SCORE" in "NEW HIGH SCORE") and point it there.
+    consteval void share_suffixes()
+    {
+        size_t start[256]{};
+        size_t length[256]{};
+        for (size_t u = 0, at = 0; u < unique; ++u)
+        {
+            start[u] = at;
+            while (codes[at++] != TEXT_END)
+            {
+            }
+            length[u] = at - start[u];
+        }
+
+        // Longest first, so the string something is folded into is never folded away itself afterwards.
+        bool folded[256]{};
+        size_t fold_into[256]{};
+        for (size_t len = TEXT_POOL_MAX_CODES; len != 0; --len)
+        {
+            for (size_t u = 0; u < unique; ++u)
+            {
+                if (length[u] != len)
+                {
+                    continue;
+                }
+                for (size_t v = 0; v < unique && !folded[u]; ++v)
+                {
+                    if (folded[v] || length[v] <= len)
+                    {
+                        continue;
+                    }
+                    size_t skip = length[v] - len;
+                    bool match = true;
+                    for (size_t i = 0; i < len && match; ++i)
+                    {
+                        match = codes[start[u] + i] == codes[start[v] + skip + i];
+                    }
+                    if (match)
+                    {
+                        folded[u] = true;
+                        fold_into[u] = v;
+                        offsets[u] = skip;
+                    }
+                }
+            }
+        }
+
+        size_t out = 0;
+        for (size_t u = 0; u < unique; ++u)
+        {
+            if (folded[u])
+            {
+                continue;
+            }
+            offsets[u] = out;
+            for (size_t i = 0; i < length[u]; ++i)
+            {
+                codes[out++] = codes[start[u] + i];
+            }
+        }
+        for (size_t u = 0; u < unique; ++u)
+        {
+            if (folded[u])
+            {
+                offsets[u] += offsets[fold_into[u]];
+            }
+        }
+        size = out;
+    }
+
+    consteval TextPoolBuilder()
+    {
+        for (size_t s = 0; s < TEXT_POOL_STRINGS; ++s)
+        {
+            bool found = false;
+            for (size_t prev = 0; prev < s && !found; ++prev)
+            {
+                if (text_equal(text_pool_strings[s], text_pool_strings[prev]))
+                {
+                    unique_index[s] = unique_index[prev];
+                    found = true;
+                }
+            }
+            if (found)
+            {
+                continue;
+            }
+
+            if (unique == 256)
+            {
+                throw "Too many strings in the text pool";
+            }
+            unique_index[s] = (uint8_t)unique++;
+            for (const char* c = text_pool_strings[s]; ; ++c)
+            {
+                if (size == TEXT_POOL_MAX_CODES)
+                {
+                    throw "The text pool is full, raise TEXT_POOL_MAX_CODES";
+                }
+                if (*c == '\0')
+                {
+                    codes[size++] = TEXT_END;
+                    break;
+                }
+                codes[size++] = text_letter(*c);
+            }
+        }
+
+        while (pairs < TEXT_MAX_PAIRS)
+        {
+            size_t best_count = 0;
+            size_t best_at = 0;
+            for (size_t i = 0; i + 1 < size; ++i)
+            {
+                uint8_t left = codes[i];
+                uint8_t right = codes[i + 1];
+                if (left == TEXT_END || right == TEXT_END)
+                {
+                    continue;
+                }
+                if (depth(left) >= TEXT_MAX_DEPTH || depth(right) >= TEXT_MAX_DEPTH)
+                {
+                    continue;
+                }
+                // Only count each pair from where it first shows up.
+                bool seen = false;
+                for (size_t j = 0; j < i && !seen; ++j)
+                {
+                    seen = codes[j] == left && codes[j + 1] == right;
+                }
+                if (seen)
+                {
+                    continue;
+                }
+                size_t count = count_pair(i);
+                if (count > best_count)
+                {
+                    best_count = count;
+                    best_at = i;
+                }
+            }
+
+            // A pair saves a byte per use and costs 2 in the dictionary.
+            if (best_count < 3)
+            {
+                break;
+            }
+
+            uint8_t code = (uint8_t)(Letter::COUNT + pairs);
+            pair_left[pairs] = codes[best_at];
+            pair_right[pairs] = codes[best_at + 1];
+            ++pairs;
+            replace_pair(pair_left[pairs - 1], pair_right[pairs - 1], code);
+        }
+
+        share_suffixes();
+    }
+};
+
+template<size_t Size, size_t Pairs>
+struct TextPool
+{
+    uint8_t bytes[Size]{};
+    uint8_t pair_left[Pairs > 0 ? Pairs : 1]{};
+    uint8_t pair_right[Pairs > 0 ? Pairs : 1]{};
+};
+
+template<size_t Size, size_t Pairs>
+consteval TextPool<Size, Pairs> compile_text_pool()
+{
+    TextPoolBuilder builder;
+    TextPool<Size, Pairs> out;
+    for (size_t i = 0; i < Size; ++i)
+    {
+        out.bytes[i] = builder.codes[i];
+    }
+    for (size_t i = 0; i < Pairs; ++i)
+    {
+        out.pair_left[i] = builder.pair_left[i];
+        out.pair_right[i] = builder.pair_right[i];
+    }
+    return out;
+}
+
+inline constexpr TextPoolBuilder text_pool_builder{};
+inline constexpr auto text_pool = compile_text_pool<text_pool_builder.size, text_pool_builder.pairs>();
+
+template<size_t N>
+struct TextLiteral
+{
+    char text[N]{};
+
+    consteval TextLiteral(const char (&str)[N])
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            text[i] = str[i];
+        }
+    }
+};
+
+template<TextLiteral L>
+consteval Text operator""_l()
+{
+    for (size_t s = 0; s < TEXT_POOL_STRINGS; ++s)
+    {
+        if (text_equal(L.text, text_pool_strings[s]))
+        {
+            return Text{ &text_pool.bytes[text_pool_builder.offsets[text_pool_builder.unique_index[s]]] };
+        }
+    }
+    throw "This string isn't in text_pool.inc";
+}
+
+/**
+ * @brief Reads the letters of a `Text` one at a time, expanding the pairs as it goes.
+ */
+struct TextReader
+{
+    const uint8_t* codes;
+    // Right halves of the pairs still to be read, innermost on top.
+    uint8_t stack[TEXT_MAX_DEPTH];
+    uint8_t depth;
+
+    TextReader() : codes(nullptr), depth(0) {}
+    explicit TextReader(Text text) : codes(text.codes), depth(0) {}
+
+    /**
+     * @return false once the end of the string is reached
+     */
+    bool next(Letter& letter)
+    {
+        uint8_t code;
+        if (depth != 0)
+        {
+            code = stack[--depth];
+        }
+        else
+        {
+            code = *codes++;
+            if (code == TEXT_END)
+            {
+                --codes;
+                return false;
+            }
+        }
+        // Go down the left side of the pair to its first letter.
+        while (code >= Letter::COUNT)
+        {
+            stack[depth++] = text_pool.pair_right[code - Letter::COUNT];
+            code = text_pool.pair_left[code - Letter::COUNT];
+        }
+        letter = (Letter)code;
+        return true;
+    }
+};
@@ -8,7 +8,10 @@
 #include <soa.h>
 
 #include "metatile.hpp"
+#include "task.hpp"
+#include "text_pool.hpp"
 #include "text_render.hpp"
+#include "vram_fast.hpp"
 
 
 /**
@@ -20,33 +23,128 @@ static const constexpr soa::Array<Metatile_2_3, Letter::COUNT> all_letters = {
     #include "font.inc"
 };
 
-[[maybe_unused]]
-static const Letter* test_string = "01001"_l;
-
 // Include the VRAM buffer and the VRAM_INDEX so we can write directly into the buffer ourselves.
 extern volatile uint8_t VRAM_BUF[128];
 extern volatile __zeropage uint8_t VRAM_INDEX;
 extern volatile __zeropage uint8_t NAME_UPD_ENABLE;
 
-extern "C" void render_string(Nametable nmt, uint8_t x, uint8_t y, const Letter str[]) {
+// neslib's copy of the mask. The buffers can only be written out directly while rendering is off.
+extern "C" volatile __zeropage uint8_t PPU_MASK_VAR;
+
+static bool rendering_on() {
+    return (PPU_MASK_VAR & (MASK_BG | MASK_SPR)) != 0;
+}
+
+// Text still to be drawn by text_task, oldest first. The first one may be partly drawn already.
+struct PendingText {
+    Nametable nmt;
+    uint8_t x;
+    uint8_t y;
+    TextReader reader;
+};
+static PendingText pending[TEXT_QUEUE_SIZE];
+static uint8_t pending_count;
+
+// Is there room in the VRAM buffer for another letter?
+static bool letter_fits() {
+#if VRAM_FAST
+    return vram_fast_free() >= VRAM_FAST_MAX_PACKET;
+#else
+    return VRAM_INDEX <= (128 - 14);
+#endif
+}
+
+// Draw one letter and move the cursor along.
+static void place_letter(Nametable nmt, uint8_t& x, uint8_t& y, Letter letter) {
+    if (!SKIP_DRAWING_SPACE || letter != Letter::SPACE) {
+        const auto t = all_letters[letter].get();
+        draw_metatile_2_3(nmt, x, y, &t);
+    }
+    if (HALF_SIZE_SPACE && letter == Letter::SPACE)
+        x += 1;
+    else
+        x += 2;
+    if (x >= 31) {
+        x = 0;
+        y += 3;
+    }
+}
+
+// Same, flushing the VRAM buffer first if it can't fit the next one.
+static void put_letter(Nametable nmt, uint8_t& x, uint8_t& y, Letter letter) {
+    place_letter(nmt, x, y, letter);
+    if (letter_fits())
+        return;
+    // With rendering on (drawing into a screen that's already showing), let NMI upload it instead.
+    if (rendering_on())
+        ppu_wait_nmi();
+    else
+#if VRAM_FAST
+        vram_fast_flush();
+#else
+        flush_vram_update2();
+#endif
+}
+
+extern "C" void render_letters(Nametable nmt, uint8_t x, uint8_t y, const Letter str[]) {
     uint8_t len = (uint8_t)str[0];
     for (uint8_t i = 1; i < len; i++) {
-        auto letter = str[i];
-        if (!SKIP_DRAWING_SPACE || letter != Letter::SPACE) {
-            const auto t = all_letters[letter].get();
-            draw_metatile_2_3(nmt, x, y, &t);
+        put_letter(nmt, x, y, str[i]);
+    }
+    NAME_UPD_ENABLE = true;
+}
+
+// Draws the queued text as the VRAM buffer has room, a frame at a time.
+static Task_Status text_task(Task& task) {
+    static Letter letter;
+    TASK_BEGIN(task);
+    while (pending_count != 0) {
+        while (pending[0].reader.next(letter)) {
+            while (!letter_fits()) {
+                NAME_UPD_ENABLE = true;
+                TASK_YIELD(task);
+            }
+            place_letter(pending[0].nmt, pending[0].x, pending[0].y, letter);
         }
-        if (HALF_SIZE_SPACE && letter == Letter::SPACE)
-            x += 1;
-        else
-            x += 2;
-        if (x >= 31) {
-            x = 0;
-            y += 3;
+        NAME_UPD_ENABLE = true;
+        for (uint8_t i = 1; i < pending_count; i++)
+            pending[i - 1] = pending[i];
+        --pending_count;
+    }
+    TASK_END(task);
+}
+
+void render_string(Nametable nmt, uint8_t x, uint8_t y, Text text) {
+    TextReader reader(text);
+    Letter letter;
+    if (rendering_on()) {
+        // Draw what fits in this frame, and leave the rest to text_task instead of waiting for NMI.
+        bool started = task_running(text_task);
+        if (!started) {
+            while (letter_fits()) {
+                if (!reader.next(letter)) {
+                    NAME_UPD_ENABLE = true;
+                    return;
+                }
+                place_letter(nmt, x, y, letter);
+            }
+            NAME_UPD_ENABLE = true;
+            // Anything still queued is from a task that was dropped on a state change.
+            pending_count = 0;
+            started = task_start(text_task);
         }
-        if (VRAM_INDEX > (128 - 14)) {
-            flush_vram_update2();
+        if (started && pending_count < TEXT_QUEUE_SIZE) {
+            pending[pending_count++] = PendingText{ nmt, x, y, reader };
+            return;
         }
     }
+    // Rendering's off (or there's no room for more queued text), draw it all now.
+    while (reader.next(letter)) {
+        put_letter(nmt, x, y, letter);
+    }
     NAME_UPD_ENABLE = true;
 }
+
+extern "C" Metatile_2_3 letter_glyph(Letter letter) {
+    return all_letters[letter].get();
+}
@@ -25,7 +25,7 @@ constexpr bool HALF_SIZE_SPACE = true;
  *        then add a new character, and update the `font.inc` to add your character at the same location
  *        in the list.
  */
-enum Letter {
+enum Letter : uint8_t {
     _0,
     _1,
     _2,
@@ -63,6 +63,7 @@ enum Letter {
     Y,
     Z,
     SPACE,
+    PLUS,
     COUNT,
 };
 
@@ -92,43 +93,38 @@ void draw_letter(Nametable nmt, uint8_t x, uint8_t y, Letter letter);
  * 
  * @param X - position from 0 to 31 to start drawing the string at
  * @param Y - position from 0 to 26 to start drawing the string at
- * @param str - List of letters to render starting at that position.
+ * @param str - Letters built at runtime (like the score), the first entry is the length of the array
+ *              including itself.
  */
-void render_string(Nametable nmt, uint8_t x, uint8_t y, const Letter letter[]);
+void render_letters(Nametable nmt, uint8_t x, uint8_t y, const Letter letter[]);
+
+/**
+ * @brief The 2x3 metatile of a letter in the font, for drawing text some other way (like with sprites).
+ */
+Metatile_2_3 letter_glyph(Letter letter);
 
 #ifdef __cplusplus
 }
 #endif
 
 #ifdef __cplusplus
-template<size_t N>
-struct LetterArray
+/**
+ * @brief A string in the text pool, made with `"..."_l` (see text_pool.hpp).
+ */
+struct Text
 {
-    Letter out[N]{};
- 
-    consteval LetterArray(char const(&text)[N])
-    {
-        out[0] = (Letter)((uint8_t)N);
-        for (size_t i = 0; i < N; i++) {
-            char c = text[i];
-            if (c == '\0') break;
-            Letter let = Letter::SPACE;
-            if (c >= '0' && c <= '9') {
-                let = (Letter) (c - '0' + Letter::_0);
-            } else if (c >= 'A' && c <= 'Z') {
-                let = (Letter) (c - 'A' + Letter::A);
-            } else if (c >= 'a' && c <= 'z') {
-                let = (Letter) (c - 'a' + Letter::A);
-            } else if (c == ' ') {
-                let = Letter::SPACE;
-            }
-            out[i+1] = let;
-        }
-    }
+    const uint8_t* codes;
 };
 
-template<LetterArray A>
-consteval auto operator""_l() {
-    return A.out;
-}
-#endif
\ No newline at end of file
+/**
+ * @brief Strings `render_string` can have waiting to be drawn on later frames.
+ */
+constexpr uint8_t TEXT_QUEUE_SIZE = 4;
+
+/**
+ * @brief Same as `render_letters`, for a string from the text pool. The string is decompressed as it's drawn.
+ *        With rendering on, the part that doesn't fit in this frame's VRAM buffer is drawn by a task over the
+ *        next frames (see task.hpp) instead of waiting for NMI, so the game keeps running meanwhile.
+ */
+void render_string(Nametable nmt, uint8_t x, uint8_t y, Text text);
+#endif
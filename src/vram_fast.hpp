@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <nesdoug.h>
+
+#include "metatile.hpp"
+
+/**
+ * @brief Specialized NMI upload path for the fixed shape VRAM updates (2x2 and 2x3 metatiles), written
+ *        in ca65 (see ca65/vram_fast.s). Turned on with -DVRAM_FAST=On, otherwise everything goes through
+ *        nesdoug's VRAM_BUF like before.
+ *
+ *        The packets go into their own buffer, which NMI uploads right before neslib works through VRAM_BUF.
+ *        Longer runs (the arena columns, the canvas, the BIG_SCORE digits) and single tiles stay in VRAM_BUF, the
+ *        stock parser is already fine for those.
+ *
+ *        CPU cycles per packet, counted from the instructions (stock numbers from nesdoug's upload loop):
+ *
+ *                         stock VRAM_BUF   VRAM_FAST
+ *          2x2 metatile        206             82
+ *          2x3 metatile        238             94
+ *
+ *        Plus about 75 cycles per frame for the fast path itself when it has anything to upload. Text is drawn as
+ *        2x3 glyphs, so a word of 3 letters (like the score without BIG_SCORE) goes from ~714 to ~360 cycles of
+ *        vblank.
+ *
+ *        Run Mesen with `vram-upload-mesen2.lua` on a build configured with -DVRAM_FAST_PROFILE=On to measure
+ *        the fast path, and with VRAM_FAST off to measure the whole stock upload for comparison.
+ */
+
+/**
+ * @brief Must match the opcodes in ca65/vram_fast.s
+ */
+enum Vram_Fast_Ops : uint8_t
+{
+    VRAM_FAST_EOF = 0x00,
+    VRAM_FAST_METATILE_2_2 = 0x01,
+    VRAM_FAST_METATILE_2_3 = 0x80,
+};
+
+/**
+ * @brief Size of the buffer in ca65/vram_fast.s. Enough for 10 glyphs of text in a frame.
+ */
+constexpr uint8_t VRAM_FAST_BUF_SIZE = 96;
+
+/**
+ * @brief Size of the largest packet, plus its EOF.
+ */
+constexpr uint8_t VRAM_FAST_MAX_PACKET = 10;
+
+#if VRAM_FAST
+
+// Defined in ca65/vram_fast.s
+extern "C" volatile uint8_t VRAM_FAST_BUF[VRAM_FAST_BUF_SIZE];
+extern "C" volatile uint8_t VRAM_FAST_INDEX;
+extern "C" volatile uint8_t VRAM_FAST_LOCK;
+
+/**
+ * @brief Upload the buffer right now. Only while rendering is off, or from NMI.
+ */
+extern "C" void vram_fast_flush();
+
+/**
+ * @brief Bytes left in the buffer for this frame.
+ */
+inline uint8_t vram_fast_free()
+{
+    return VRAM_FAST_BUF_SIZE - VRAM_FAST_INDEX;
+}
+
+#endif
+
+extern volatile __zeropage uint8_t VRAM_INDEX;
+
+/**
+ * @brief Queue a single tile into VRAM_BUF. With or without VRAM_FAST, a lone tile costs about the same in either
+ *        upload path, so it doesn't get a packet of its own.
+ *
+ * @return false if the buffer is full this frame and nothing was queued
+ */
+inline bool vram_tile(uint8_t tile, uint16_t ppu_address)
+{
+    // one_vram_buffer doesn't check for room itself. It takes 3 bytes plus the terminator.
+    if (VRAM_INDEX > 128 - 4)
+    {
+        return false;
+    }
+    one_vram_buffer(tile, ppu_address);
+    return true;
+}
@@ -0,0 +1,161 @@
+#include "waves.hpp"
+#include "enemy.hpp"
+#include "clock.hpp"
+
+#include <cstdint>
+
+// The spawn pattern of the game. The first loop starts at one enemy every 2 seconds with an ammo pickup every
+// 10 seconds, then every time around the waits get a little shorter.
+static constexpr WaveCommand wave_script[] =
+{
+    wave_max_enemies(4),
+    wave_kill_delay(SECONDS(1)),
+
+    // Warm up with a couple of slower spawns before the loop.
+    wave_wait(SECONDS(2)),
+    wave_spawn(ENEMY_KIND_BOT, WAVE_REGION_AWAY, 1),
+    wave_wait(SECONDS(2)),
+    wave_spawn(ENEMY_KIND_BOT, WAVE_REGION_OPPOSITE, 1),
+
+    wave_label(),
+    wave_wait(SECONDS(2)),
+    wave_spawn(ENEMY_KIND_BOT, WAVE_REGION_AWAY, 1),
+    wave_wait(SECONDS(2)),
+    wave_spawn(ENEMY_KIND_BOT, WAVE_REGION_AWAY, 1),
+    wave_wait(SECONDS(2)),
+    wave_spawn(ENEMY_KIND_BOT, WAVE_REGION_OPPOSITE, 1),
+    wave_wait(SECONDS(2)),
+    wave_spawn(ENEMY_KIND_BOT, WAVE_REGION_AWAY, 1),
+    wave_wait(SECONDS(2)),
+    wave_ammo(),
+    wave_spawn(ENEMY_KIND_BOT, WAVE_REGION_AWAY, 1),
+    wave_ramp(SECONDS(0.1)),
+    wave_loop(),
+};
+
+static constexpr auto wave_bytecode = compile_wave_script<wave_bytecode_size(wave_script)>(wave_script);
+
+// Interpreter state
+static uint8_t pc;
+static uint8_t wait;
+static uint8_t ramp;
+static uint8_t max_enemies;
+static uint8_t kill_delay;
+
+// Enemies left to spawn from the last SPAWN, one per frame.
+static uint8_t spawn_left;
+static uint8_t spawn_kind;
+static Wave_Regions spawn_region;
+
+void waves_start()
+{
+    pc = 0;
+    wait = 0;
+    ramp = 0;
+    max_enemies = 0;
+    kill_delay = 0;
+    spawn_left = 0;
+}
+
+static void take_spawn(WaveAction& action)
+{
+    --spawn_left;
+    action.spawn_enemy = true;
+    action.enemy_kind = spawn_kind;
+    action.region = spawn_region;
+}
+
+WaveAction waves_update()
+{
+    WaveAction action = {};
+
+    if (spawn_left != 0)
+    {
+        take_spawn(action);
+        return action;
+    }
+    if (wait != 0)
+    {
+        --wait;
+        return action;
+    }
+
+    const uint8_t* code = wave_bytecode.bytes;
+    for (uint8_t ops = 0; ops < WAVE_MAX_OPS_PER_FRAME; ++ops)
+    {
+        uint8_t op = code[pc];
+        uint8_t arg = code[pc + 1];
+        switch (op)
+        {
+            case WAVE_OP_WAIT:
+            {
+                pc += 2;
+                uint8_t frames = (arg > ramp + WAVE_MIN_WAIT) ? arg - ramp : WAVE_MIN_WAIT;
+                // This frame is the first one of the wait.
+                wait = frames - 1;
+                return action;
+            }
+            case WAVE_OP_SPAWN:
+            {
+                // Only one spawn per frame, the next SPAWN waits for the next frame.
+                if (action.spawn_enemy || spawn_left != 0)
+                {
+                    return action;
+                }
+                pc += 2;
+                spawn_kind = arg >> 6;
+                spawn_region = (Wave_Regions)((arg >> 4) & 0x03);
+                spawn_left = arg & 0x0f;
+                if (spawn_left != 0)
+                {
+                    take_spawn(action);
+                }
+                break;
+            }
+            case WAVE_OP_AMMO:
+            {
+                pc += 1;
+                action.spawn_ammo = true;
+                break;
+            }
+            case WAVE_OP_MAX_ENEMIES:
+            {
+                pc += 2;
+                max_enemies = arg;
+                break;
+            }
+            case WAVE_OP_KILL_DELAY:
+            {
+                pc += 2;
+                kill_delay = arg;
+                break;
+            }
+            case WAVE_OP_RAMP:
+            {
+                pc += 2;
+                // Saturate, once the waits are at WAVE_MIN_WAIT there's nothing left to ramp anyway.
+                ramp = (ramp > 0xff - arg) ? 0xff : ramp + arg;
+                break;
+            }
+            case WAVE_OP_LOOP:
+            {
+                pc = arg;
+                break;
+            }
+        }
+    }
+    return action;
+}
+
+void waves_enemy_killed()
+{
+    if (wait != 0 && kill_delay != 0)
+    {
+        wait = kill_delay;
+    }
+}
+
+uint8_t waves_max_enemies()
+{
+    return max_enemies;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "clock.hpp"
+
+/**
+ * @brief Enemy waves are written as a script of `WaveCommand`s (see `wave_script` in waves.cpp), compiled to
+ *        bytecode at compile time and run by `waves_update` once per tick. Tuning the difficulty curve is
+ *        a script edit, and the per-tick cost is a counter decrement on most ticks. Times are in ticks of 1/60s (see clock.hpp),
+ *        write them with SECONDS().
+ *
+ *        Bytecode layout, one opcode byte followed by its argument (if it has one):
+ *          WAIT n        - do nothing for n ticks (shortened by the ramp, see below)
+ *          SPAWN k|r|c   - spawn c enemies of kind k in region r, one per tick
+ *          AMMO          - spawn an ammo pickup
+ *          MAX_ENEMIES n - from now on spawns fail while n enemies are alive
+ *          KILL_DELAY n  - after an enemy is shot, the current WAIT is reset to n ticks
+ *          RAMP n        - every later WAIT gets n ticks shorter (down to WAVE_MIN_WAIT)
+ *          LOOP offset   - jump back to the last `wave_label()`
+ */
+enum Wave_Ops : uint8_t
+{
+    WAVE_OP_WAIT = 0,
+    WAVE_OP_SPAWN,
+    WAVE_OP_AMMO,
+    WAVE_OP_MAX_ENEMIES,
+    WAVE_OP_KILL_DELAY,
+    WAVE_OP_RAMP,
+    WAVE_OP_LOOP,
+    // Only used while compiling, marks the target of the next LOOP. Emits no bytes.
+    WAVE_OP_LABEL,
+};
+
+/**
+ * @brief Where a spawned enemy appears, relative to the screen quadrant the player is in.
+ *        AWAY     - one of the 3 other quadrants at random
+ *        OPPOSITE - the diagonally opposite quadrant
+ */
+enum Wave_Regions : uint8_t
+{
+    WAVE_REGION_AWAY = 0,
+    WAVE_REGION_OPPOSITE,
+};
+
+/**
+ * @brief A tick count for a WAIT, KILL_DELAY or RAMP. The argument is a single byte, so anything past 255 ticks
+ *        (4.25 seconds) is a compile error instead of silently wrapping around.
+ */
+struct WaveTicks
+{
+    uint8_t ticks;
+
+    consteval WaveTicks(uint16_t value) : ticks((uint8_t)value)
+    {
+        if (value > 255)
+        {
+            throw "Wave durations are at most 255 ticks";
+        }
+    }
+};
+
+// The ramp never makes a WAIT shorter than this.
+constexpr uint8_t WAVE_MIN_WAIT = WaveTicks(SECONDS(0.5)).ticks;
+
+// Upper bound on the number of opcodes run in one frame, so a chain of settings and a LOOP can't
+// turn into a long frame. Whatever is left runs on the next frame.
+constexpr uint8_t WAVE_MAX_OPS_PER_FRAME = 4;
+
+struct WaveCommand
+{
+    Wave_Ops op;
+    uint8_t arg;
+};
+
+constexpr WaveCommand wave_wait(WaveTicks ticks) { return { WAVE_OP_WAIT, ticks.ticks }; }
+constexpr WaveCommand wave_spawn(uint8_t kind, Wave_Regions region, uint8_t count)
+{
+    return { WAVE_OP_SPAWN, (uint8_t)((kind << 6) | (region << 4) | (count & 0x0f)) };
+}
+constexpr WaveCommand wave_ammo() { return { WAVE_OP_AMMO, 0 }; }
+constexpr WaveCommand wave_max_enemies(uint8_t count) { return { WAVE_OP_MAX_ENEMIES, count }; }
+constexpr WaveCommand wave_kill_delay(WaveTicks ticks) { return { WAVE_OP_KILL_DELAY, ticks.ticks }; }
+constexpr WaveCommand wave_ramp(WaveTicks ticks) { return { WAVE_OP_RAMP, ticks.ticks }; }
+constexpr WaveCommand wave_label() { return { WAVE_OP_LABEL, 0 }; }
+constexpr WaveCommand wave_loop() { return { WAVE_OP_LOOP, 0 }; }
+
+consteval uint8_t wave_op_size(Wave_Ops op)
+{
+    switch (op)
+    {
+        case WAVE_OP_LABEL:
+            return 0;
+        case WAVE_OP_AMMO:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+template<size_t N>
+consteval size_t wave_bytecode_size(const WaveCommand (&script)[N])
+{
+    size_t size = 0;
+    for (const WaveCommand& cmd : script)
+    {
+        size += wave_op_size(cmd.op);
+    }
+    return size;
+}
+
+template<size_t Size>
+struct WaveBytecode
+{
+    uint8_t bytes[Size]{};
+};
+
+/**
+ * @brief Turn a script into bytecode. LOOPs are resolved to the byte offset of the label before them.
+ *        A script must end with a LOOP, and every loop needs a WAIT in it, or it would never give the
+ *        frame back. Both are checked here, so a bad script is a compile error.
+ */
+template<size_t Size, size_t N>
+consteval WaveBytecode<Size> compile_wave_script(const WaveCommand (&script)[N])
+{
+    static_assert(Size <= 256, "Wave scripts are addressed with 8 bits");
+
+    WaveBytecode<Size> out;
+    size_t pc = 0;
+    size_t label = 0;
+    bool waited_since_label = false;
+    for (const WaveCommand& cmd : script)
+    {
+        if (cmd.op == WAVE_OP_LABEL)
+        {
+            label = pc;
+            waited_since_label = false;
+            continue;
+        }
+        if (cmd.op == WAVE_OP_WAIT)
+        {
+            if (cmd.arg == 0)
+            {
+                throw "WAIT needs at least 1 tick";
+            }
+            waited_since_label = true;
+        }
+        if (cmd.op == WAVE_OP_LOOP && !waited_since_label)
+        {
+            throw "A wave loop must WAIT at least once";
+        }
+
+        out.bytes[pc++] = cmd.op;
+        if (wave_op_size(cmd.op) == 2)
+        {
+            out.bytes[pc++] = (cmd.op == WAVE_OP_LOOP) ? (uint8_t)label : cmd.arg;
+        }
+    }
+    if (script[N - 1].op != WAVE_OP_LOOP)
+    {
+        throw "A wave script must end with a LOOP";
+    }
+    return out;
+}
+
+/**
+ * @brief What the script wants done this frame. The game does the actual spawning.
+ */
+struct WaveAction
+{
+    bool spawn_enemy;
+    uint8_t enemy_kind;
+    Wave_Regions region;
+    bool spawn_ammo;
+};
+
+/**
+ * @brief Restart the script from the top.
+ */
+void waves_start();
+
+/**
+ * @brief Step the script by one tick.
+ */
+WaveAction waves_update();
+
+/**
+ * @brief Tell the script an enemy was shot, which applies the KILL_DELAY.
+ */
+void waves_enemy_killed();
+
+/**
+ * @brief Current MAX_ENEMIES setting.
+ */
+uint8_t waves_max_enemies();
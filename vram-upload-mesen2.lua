@@ -0,0 +1,81 @@
+-- Use this script with Mesen 2 to compare the vblank time spent on nametable uploads with and without VRAM_FAST.
+--
+-- On a build configured with -DVRAM_FAST=On -DVRAM_FAST_PROFILE=On, vram_fast_flush() in ca65/vram_fast.s writes a
+-- non-zero value to $401F before it starts uploading and 0 when it's done, so the difference in the CPU cycle
+-- counter is the cost of the fast path.
+--
+-- On any build it also reports how far into NMI the last PPU_DATA ($2007) write happens, which covers the stock
+-- VRAM_BUF upload too. Run the same part of the game with VRAM_FAST on and off and compare the two.
+-- For example:
+--   $ mesen gg-llvm-mos-sample.nes vram-upload-mesen2.lua
+
+nmi_cycle = 0
+last_data_cycle = 0
+fast_start = 0
+
+frames = 0
+upload_frames = 0
+upload_total = 0
+upload_worst = 0
+fast_frames = 0
+fast_total = 0
+fast_worst = 0
+
+function report_frame()
+  if (last_data_cycle > nmi_cycle) then
+    cost = last_data_cycle - nmi_cycle
+    upload_frames = upload_frames + 1
+    upload_total = upload_total + cost
+    if (cost > upload_worst) then
+      upload_worst = cost
+    end
+  end
+end
+
+function on_nmi()
+  report_frame()
+  nmi_cycle = emu.getState()["cpu.cycleCount"]
+  last_data_cycle = 0
+
+  frames = frames + 1
+  -- Report about once a second, skipping seconds where nothing was uploaded
+  if (frames == 60) then
+    if (upload_frames ~= 0) then
+      msg = "last $2007 write after NMI avg: " .. math.floor(upload_total / upload_frames) .. " worst: " .. upload_worst
+      if (fast_frames ~= 0) then
+        msg = msg .. " | fast upload avg: " .. math.floor(fast_total / fast_frames) .. " worst: " .. fast_worst
+      end
+      emu.log(msg)
+    end
+    frames = 0
+    upload_frames = 0
+    upload_total = 0
+    upload_worst = 0
+    fast_frames = 0
+    fast_total = 0
+    fast_worst = 0
+  end
+end
+
+function on_data(address, value)
+  last_data_cycle = emu.getState()["cpu.cycleCount"]
+end
+
+function on_marker(address, value)
+  cycle = emu.getState()["cpu.cycleCount"]
+  if (value ~= 0) then
+    fast_start = cycle
+    return
+  end
+
+  cost = cycle - fast_start
+  fast_frames = fast_frames + 1
+  fast_total = fast_total + cost
+  if (cost > fast_worst) then
+    fast_worst = cost
+  end
+end
+
+emu.addEventCallback(on_nmi, emu.eventType.nmi)
+emu.addMemoryCallback(on_data, emu.callbackType.write, 0x2007)
+emu.addMemoryCallback(on_marker, emu.callbackType.write, 0x401F)